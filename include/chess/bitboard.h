@@ -12,6 +12,7 @@
 
 #include "types.h"
 #include "util.h"
+#include <array>
 #include <iostream>
 
 #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
@@ -22,27 +23,36 @@
 #define NO_INTRIN
 #endif
 
+// Slider lookups index the attack tables with PEXT instead of a magic multiply.
+// Only worth it where PEXT is fast in hardware (Intel Haswell+, AMD Zen 3+), so it is opt-in: cmake -DUSE_PEXT=ON
+#if defined(USE_PEXT)
+#if defined(NO_INTRIN)
+#error "USE_PEXT needs an x86-64 CPU with BMI2"
+#endif
+#endif
+
 namespace chess
 {
 
     //-----------------------------------------------------------------------------
-    // PRE-COMPUTED ATTACK TABLES & INITIALIZATION
+    // PRE-COMPUTED ATTACK TABLES
     //
-    // These tables are defined in uint64_t.cpp and populated by the init() function.
+    // These tables are defined in uint64_t.cpp. All of them are ready before
+    // main() runs, most are compile-time constants.
     //-----------------------------------------------------------------------------
 
-    // A one-time initialization function to be called at program startup.
-    void init();
+    // Nothing is left to initialize; kept so existing callers keep working.
+    inline void init() {}
 
     // Pawn attacks [color][square]
-    extern uint64_t PawnAttacks[COLOR_NB][SQUARE_NB];
+    extern const std::array<std::array<uint64_t, SQUARE_NB>, COLOR_NB> PawnAttacks;
     // Knight attacks [square]
-    extern uint64_t KnightAttacks[SQUARE_NB];
+    extern const std::array<uint64_t, SQUARE_NB> KnightAttacks;
     // King attacks [square]
-    extern uint64_t KingAttacks[SQUARE_NB];
+    extern const std::array<uint64_t, SQUARE_NB> KingAttacks;
 
-    extern uint64_t files[8];
-    extern uint64_t ranks[8];
+    constexpr uint64_t files[8] = {util::FileA, util::FileB, util::FileC, util::FileD, util::FileE, util::FileF, util::FileG, util::FileH};
+    constexpr uint64_t ranks[8] = {util::Rank1, util::Rank2, util::Rank3, util::Rank4, util::Rank5, util::Rank6, util::Rank7, util::Rank8};
 
     //-----------------------------------------------------------------------------
     // MAGIC BITBOARDS FOR SLIDER PIECES (ROOK, BISHOP)
@@ -51,16 +61,33 @@ namespace chess
     // Magic struct to hold data for magic uint64_t lookups
     struct Magic
     {
-        uint64_t mask;  // Mask to isolate relevant blocker squares
-        uint64_t magic; // The "magic" number
-        uint8_t shift;  // Shift value for hashing
+        uint64_t mask;      // Mask to isolate relevant blocker squares
+        uint64_t magic;     // The "magic" number
+        uint8_t shift;      // Shift value for hashing
+        uint64_t *attacks;  // This square's slice of the shared attack table
+
+        // Position of the attack set for these blockers inside this square's slice
+        inline unsigned index(uint64_t occupancy) const
+        {
+#if defined(USE_PEXT)
+            return unsigned(_pext_u64(occupancy, mask));
+#else
+            return unsigned(((occupancy & mask) * magic) >> shift);
+#endif
+        }
     };
 
+    // Every square only gets as many entries as its index can reach ("fancy" magics),
+    // packed back to back. Sized for the larger of the two layouts: 2^popcount(mask)
+    // entries per square with PEXT, 2^(64 - shift) with magics.
+    constexpr int ROOK_TABLE_SIZE = 0x19000;  // 102400 entries, 800 KB
+    constexpr int BISHOP_TABLE_SIZE = 0x1480; // 5248 entries, 41 KB
+
     // Extern declarations for magic numbers and attack tables (defined in uint64_t.cpp)
-    extern Magic RookMagics[SQUARE_NB];
-    extern Magic BishopMagics[SQUARE_NB];
-    extern uint64_t RookAttacks[SQUARE_NB][4096];  // Max 2^12 relevant squares for rooks
-    extern uint64_t BishopAttacks[SQUARE_NB][512]; // Max 2^9 relevant squares for bishops
+    extern const std::array<Magic, SQUARE_NB> RookMagics;
+    extern const std::array<Magic, SQUARE_NB> BishopMagics;
+    extern uint64_t RookTable[ROOK_TABLE_SIZE];
+    extern uint64_t BishopTable[BISHOP_TABLE_SIZE];
 
     const uint64_t passed_pawn_masks_white[SQUARE_NB] = {217020518514230016ULL, 506381209866536704ULL, 1012762419733073408ULL, 2025524839466146816ULL, 4051049678932293632ULL, 8102099357864587264ULL, 16204198715729174528ULL, 13889313184910721024ULL, 217020518514229248ULL, 506381209866534912ULL, 1012762419733069824ULL, 2025524839466139648ULL, 4051049678932279296ULL, 8102099357864558592ULL, 16204198715729117184ULL, 13889313184910671872ULL, 217020518514032640ULL, 506381209866076160ULL, 1012762419732152320ULL, 2025524839464304640ULL, 4051049678928609280ULL, 8102099357857218560ULL, 16204198715714437120ULL, 13889313184898088960ULL, 217020518463700992ULL, 506381209748635648ULL, 1012762419497271296ULL, 2025524838994542592ULL, 4051049677989085184ULL, 8102099355978170368ULL, 16204198711956340736ULL, 13889313181676863488ULL, 217020505578799104ULL, 506381179683864576ULL, 1012762359367729152ULL, 2025524718735458304ULL, 4051049437470916608ULL, 8102098874941833216ULL, 16204197749883666432ULL, 13889312357043142656ULL, 217017207043915776ULL, 506373483102470144ULL, 1012746966204940288ULL, 2025493932409880576ULL, 4050987864819761152ULL, 8101975729639522304ULL, 16203951459279044608ULL, 13889101250810609664ULL, 216172782113783808ULL, 504403158265495552ULL, 1008806316530991104ULL, 2017612633061982208ULL, 4035225266123964416ULL, 8070450532247928832ULL, 16140901064495857664ULL, 13835058055282163712ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL, 0ULL};
 
@@ -69,19 +96,15 @@ namespace chess
     // Generates rook attacks using the magic uint64_t lookup.
     inline uint64_t get_orthogonal_slider_attacks(Square s, uint64_t occupancy)
     {
-        occupancy &= RookMagics[s].mask;
-        occupancy *= RookMagics[s].magic;
-        occupancy >>= RookMagics[s].shift;
-        return RookAttacks[s][occupancy];
+        const Magic &m = RookMagics[s];
+        return m.attacks[m.index(occupancy)];
     }
 
     // Generates bishop attacks using the magic uint64_t lookup.
     inline uint64_t get_diagonal_slider_attacks(Square s, uint64_t occupancy)
     {
-        occupancy &= BishopMagics[s].mask;
-        occupancy *= BishopMagics[s].magic;
-        occupancy >>= BishopMagics[s].shift;
-        return BishopAttacks[s][occupancy];
+        const Magic &m = BishopMagics[s];
+        return m.attacks[m.index(occupancy)];
     }
 
     //-----------------------------------------------------------------------------
@@ -108,10 +131,8 @@ namespace chess
                   << std::endl;
     }
 
-    extern uint64_t Between[chess::SQUARE_NB][chess::SQUARE_NB];
-    extern uint64_t Rays[chess::SQUARE_NB][chess::SQUARE_NB];
-
-    // generator (can be used to fill the tables at program init if not constexpr-hardened)
-    void generate_between_and_ray_tables() noexcept;
+    extern const std::array<std::array<uint64_t, chess::SQUARE_NB>, chess::SQUARE_NB> Between;
+    extern const std::array<std::array<uint64_t, chess::SQUARE_NB>, chess::SQUARE_NB> Rays;
+    extern const std::array<std::array<uint64_t, chess::SQUARE_NB>, chess::SQUARE_NB> Line; // whole rank/file/diagonal through both squares, 0 if not aligned
 
 } // namespace chess
\ No newline at end of file
@@ -1,26 +1,31 @@
 #pragma once
 #include <cstdint>
 #include <array>
+#include <type_traits>
 #include <vector>
 #include <string>
 #include <string>
 #include "types.h"
 #include "bitboard.h"
+#include "psqt.h"
 
 constexpr uint64_t ONE = 1ULL;
 
-// ---------- Board state ----------
-class Board {
-public:
+// ---------- Position state ----------
+// Everything that describes one position and nothing that points elsewhere, so a search
+// thread can take its own copy with a plain memcpy. Board adds the move history on top.
+struct Position {
     // --- Bitboards: per-piece & color
     // 1 -> WP, 2 -> WN, 3 -> WB, 4 -> WR, 5 -> WQ, 6 -> WK 
     // 9 -> BP, 10 -> BN, 11-> BB, 12 -> BR, 13 -> BQ, 14 -> BK
     uint64_t bitboard[16];  // 1..6 white, 9..14 black
 
-    uint64_t pinned;         // single pass using ray attacks
-    uint64_t checks;       // squares of checking pieces
+    // Pieces of the side to move that are pinned to their king, or PINS_UNKNOWN until
+    // pinned_pieces() first needs them. Read through pinned_pieces().
+    static constexpr uint64_t PINS_UNKNOWN = ~0ULL;
+    mutable uint64_t pinned;
+    uint64_t checks;       // squares of checking pieces, always up to date
     bool double_check;
-    uint64_t check_mask; // rays + checker squares
 
     // --- Square array for O(1) lookup
     chess::Piece board_array[64];
@@ -45,40 +50,50 @@ public:
     // --- Zobrist hash
     uint64_t zobrist_key;
     uint64_t zobrist_pawn_key; // optional pawn hash
-    int32_t material_white;
-    int32_t material_black;
-    int32_t game_phase;
-
-    // --- Undo stack
-    std::vector<chess::Undo> undo_stack;
+    // --- Incremental evaluation terms, kept in step by make_move/unmake_move
+    psqt::Score psq;                                // material + PST, White minus Black
+    int32_t non_pawn_material[chess::COLOR_NB];     // knights, bishops, rooks and queens, in SEE units
+    int32_t game_phase;                             // 24 at the start; may exceed it after promotions, clamp when used
 
     // Cached occupancies
     uint64_t white_occupied;
     uint64_t black_occupied;
     uint64_t occupied;
 
-    // ---------- API / helper prototypes ----------
+    // --- Attack maps per colour, filled on first use by attacks_by() and dropped whenever a piece moves
+    mutable uint64_t attacked_by[chess::COLOR_NB][chess::PIECE_TYPE_NB];   // [c][NO_PIECE_TYPE]: by any piece of c
+    mutable uint8_t king_zone_hits[chess::COLOR_NB][chess::PIECE_TYPE_NB]; // attacks of c on the squares around the other king, one per attacker and square
+    mutable uint8_t threats_known;                                         // bit c set once the maps of colour c are filled
 
-    inline uint64_t get_white() { 
-        update_occupancies(); 
-        return white_occupied; 
-    }
+    // --- Check information for the side to move, filled on first use by gives_check() and friends
+    mutable uint64_t check_sq[chess::PIECE_TYPE_NB]; // squares from which a piece of that type would attack the enemy king
+    mutable uint64_t discoverers;                    // our pieces between one of our sliders and the enemy king
+    mutable bool check_info_known;
+};
 
-    inline uint64_t get_black() { 
-        update_occupancies(); 
-        return black_occupied; 
-    }
+static_assert(std::is_trivially_copyable<Position>::value, "Position must stay memcpy-able");
+
+// Hashes of the positions played before a search root, oldest first.
+// Built once per search and shared read-only by every thread.
+using GameHistory = std::vector<uint64_t>;
+
+// ---------- Board state ----------
+class Board : public Position {
+public:
+    // --- Undo stack: moves made on this board
+    chess::UndoStack undo_stack;
+
+    // --- Positions before the first undo entry, for repetition detection. Not owned; may be null.
+    const GameHistory* history = nullptr;
+
+    // ---------- API / helper prototypes ----------
+
+    // Occupancies are kept up to date by make_move/unmake_move, no recomputation needed
+    inline uint64_t get_white() const { return white_occupied; }
+    inline uint64_t get_black() const { return black_occupied; }
+    inline uint64_t get_occupied() const { return occupied; }
+    inline uint64_t get_empty() const { return ~occupied; }
 
-    inline uint64_t get_occupied() { 
-        update_occupancies(); 
-        return occupied; 
-    }
-    
-    inline uint64_t get_empty() { 
-        update_occupancies(); 
-        return ~occupied; 
-    }
-    
     inline bool is_square_occupied(const chess::Square sq) const {
         return ((ONE << sq) & occupied);
     }
@@ -89,7 +104,64 @@ public:
     }
 
     inline uint64_t piece_bb(int piece_index) const { return bitboard[piece_index]; }
+
+    // Knights, bishops, rooks or queens left; without them zugzwang is common.
+    inline bool has_non_pawn_material(bool white) const {
+        return non_pawn_material[white ? chess::WHITE : chess::BLACK] > 0;
+    }
     
+    // --- Legality masks for the side to move
+
+    inline uint64_t pinned_pieces() const {
+        if (pinned == PINS_UNKNOWN) compute_pins();
+        return pinned;
+    }
+
+    // Destinations that resolve a single check: capture the checker or block the ray. Everything if not in check.
+    // Only meaningful for a single check; in double check only the king moves.
+    inline uint64_t evasion_mask() const {
+        if (!checks) return ~0ULL;
+        const chess::Square king_sq = white_to_move ? white_king_sq : black_king_sq;
+        return chess::Between[king_sq][__builtin_ctzll(checks)] | checks;
+    }
+
+    // A pinned piece may only move along the line through its king and the pinner.
+    inline uint64_t pin_mask(chess::Square from) const {
+        const chess::Square king_sq = white_to_move ? white_king_sq : black_king_sq;
+        return (pinned_pieces() & (ONE << from)) ? chess::Line[king_sq][from] : ~0ULL;
+    }
+
+    // --- Attack maps, built once per position and colour and shared by movegen and evaluation
+
+    inline bool has_attack_map(chess::Color c) const { return threats_known & (1 << c); }
+
+    // Squares attacked by pieces of type pt of colour c, or by any of them for NO_PIECE_TYPE
+    inline uint64_t attacks_by(chess::Color c, chess::PieceType pt = chess::NO_PIECE_TYPE) const {
+        if (!has_attack_map(c)) compute_threats(c);
+        return attacked_by[c][pt];
+    }
+
+    // How many times pieces of type pt of colour c hit the squares next to the other king
+    inline int king_zone_attacks(chess::Color c, chess::PieceType pt) const {
+        if (!has_attack_map(c)) compute_threats(c);
+        return king_zone_hits[c][pt];
+    }
+
+    // --- Check information for the side to move
+
+    // Squares from which a piece of this type would attack the enemy king
+    inline uint64_t check_squares(chess::PieceType pt) const {
+        if (!check_info_known) compute_check_info();
+        return check_sq[pt];
+    }
+
+    // Our pieces standing between one of our sliders and the enemy king: moving them off
+    // the line gives a discovered check.
+    inline uint64_t discovered_check_candidates() const {
+        if (!check_info_known) compute_check_info();
+        return discoverers;
+    }
+
     inline void update_king_squares_from_bitboards() {
         white_king_sq = bitboard[chess::WK] ? (chess::Square)__builtin_ctzll(bitboard[chess::WK]) : chess::SQUARE_NONE;
         black_king_sq = bitboard[chess::BK] ? (chess::Square)__builtin_ctzll(bitboard[chess::BK]) : chess::SQUARE_NONE;
@@ -97,6 +169,7 @@ public:
 
 public:
     Board();
+    Board(const Position& pos, const GameHistory* history); // starts with an empty undo stack
     void clear();
     void set_fen(std::string &fen_cstr);
     std::string to_fen() const;
@@ -107,60 +180,112 @@ public:
     // Make/unmake
     void make_move(const chess::Move &mv);
     void unmake_move(const chess::Move &mv);
+    void make_null_move();   // pass the turn; only valid when not in check
+    void unmake_null_move();
 
     // Queries
     bool isempty(chess::Square sq) const { return board_array[sq] == chess::NO_PIECE; }
     chess::Piece piece_on_sq(chess::Square sq) const { return board_array[sq]; }
     bool square_attacked(chess::Square sq, bool by_white) const; // uses attack tables
     uint64_t attackers_to(chess::Square sq, bool by_white) const;
+    uint64_t attackers_to(chess::Square sq, uint64_t occupancy) const; // both colours, sliders see through removed pieces
+    bool see_ge(const chess::Move& mv, int threshold) const;          // static exchange evaluation >= threshold
+    bool king_move_safe(chess::Square to) const;      // the king on "to" is not attacked, looking through its old square
+    bool ep_capture_legal(chess::Square from) const;  // en passant from "from" does not leave our king in check
+    bool gives_check(const chess::Move& mv) const;    // a legal move of the side to move checks the enemy king
     bool is_position_legal();
 
+    // History
+    GameHistory game_history() const;    // hashes before every move made so far, history included
+    bool is_repetition_draw() const;     // the position occurred twice before since the last irreversible move
+
 private:
+    // The colour occupancy a piece belongs to
+    inline uint64_t& occupancy_of(chess::Piece piece) {
+        return chess::color_of(piece) == chess::WHITE ? white_occupied : black_occupied;
+    }
+
+    // The helpers below keep bitboards, board_array and occupancies in step with XOR deltas.
+    // King squares are left to the caller.
+
     //assumes to_sq is empty
     inline void move_piece_bb(chess::Piece piece, chess::Square from_sq, chess::Square to_sq) {
-        bitboard[piece] ^= (ONE << from_sq) | (ONE << to_sq);
+        const uint64_t delta = (ONE << from_sq) | (ONE << to_sq);
+        bitboard[piece] ^= delta;
+        occupancy_of(piece) ^= delta;
+        occupied ^= delta;
         board_array[from_sq] = chess::NO_PIECE;
         board_array[to_sq] = piece;
-        update_occupancies();
-        if (piece == chess::WK || piece == chess::BK) update_king_squares_from_bitboards();
     }
 
     inline void restore_piece_bb(chess::Piece piece, chess::Square from_sq, chess::Square to_sq) {
-        bitboard[piece] ^= (ONE << from_sq) | (ONE << to_sq);
+        const uint64_t delta = (ONE << from_sq) | (ONE << to_sq);
+        bitboard[piece] ^= delta;
+        occupancy_of(piece) ^= delta;
+        occupied ^= delta;
         board_array[from_sq] = piece;
         board_array[to_sq] = chess::NO_PIECE;
-        update_occupancies();
-        if (piece == chess::WK || piece == chess::BK) update_king_squares_from_bitboards();
     }
 
+    //assumes sq is empty
+    inline void put_piece(chess::Piece piece, chess::Square sq) {
+        const uint64_t bit = ONE << sq;
+        bitboard[piece] ^= bit;
+        occupancy_of(piece) ^= bit;
+        occupied ^= bit;
+        board_array[sq] = piece;
+    }
+
+    //assumes piece is on sq
+    inline void remove_piece(chess::Piece piece, chess::Square sq) {
+        const uint64_t bit = ONE << sq;
+        bitboard[piece] ^= bit;
+        occupancy_of(piece) ^= bit;
+        occupied ^= bit;
+        board_array[sq] = chess::NO_PIECE;
+    }
+
+    // Full recomputation, used when a position is set up
     inline void update_occupancies() {
         white_occupied = bitboard[chess::WP] | bitboard[chess::WN] | bitboard[chess::WB] | bitboard[chess::WR] | bitboard[chess::WQ] | bitboard[chess::WK];
         black_occupied = bitboard[chess::BP] | bitboard[chess::BN] | bitboard[chess::BB] | bitboard[chess::BR] | bitboard[chess::BQ] | bitboard[chess::BK];
         occupied       = white_occupied | black_occupied;
     }
 
-    inline void update_game_phase() {
-        this->game_phase = 0;
+    // Debug builds check the incremental occupancies against update_occupancies()
+    bool occupancies_consistent() const;
+
+    // Material and phase only; unmake_move restores psq from the undo record
+    inline void add_material(chess::Piece piece) {
+        const chess::PieceType pt = chess::type_of(piece);
+        if (pt != chess::PAWN) non_pawn_material[chess::color_of(piece)] += util::see_values[pt];
+        game_phase += util::phase_values[pt];
+    }
 
-        // White pieces
-        this->game_phase += util::count_bits(this->bitboard[chess::WP]) * util::phase_values[chess::PAWN];
-        this->game_phase += util::count_bits(this->bitboard[chess::WN]) * util::phase_values[chess::KNIGHT];
-        this->game_phase += util::count_bits(this->bitboard[chess::WB]) * util::phase_values[chess::BISHOP];
-        this->game_phase += util::count_bits(this->bitboard[chess::WR]) * util::phase_values[chess::ROOK];
-        this->game_phase += util::count_bits(this->bitboard[chess::WQ]) * util::phase_values[chess::QUEEN];
+    inline void remove_material(chess::Piece piece) {
+        const chess::PieceType pt = chess::type_of(piece);
+        if (pt != chess::PAWN) non_pawn_material[chess::color_of(piece)] -= util::see_values[pt];
+        game_phase -= util::phase_values[pt];
+    }
 
-        // Black pieces
-        this->game_phase += util::count_bits(this->bitboard[chess::BP]) * util::phase_values[chess::PAWN];
-        this->game_phase += util::count_bits(this->bitboard[chess::BN]) * util::phase_values[chess::KNIGHT];
-        this->game_phase += util::count_bits(this->bitboard[chess::BB]) * util::phase_values[chess::BISHOP];
-        this->game_phase += util::count_bits(this->bitboard[chess::BR]) * util::phase_values[chess::ROOK];
-        this->game_phase += util::count_bits(this->bitboard[chess::BQ]) * util::phase_values[chess::QUEEN];
+    // A piece appears on / disappears from sq: update the incremental evaluation terms
+    inline void add_to_accumulators(chess::Piece piece, chess::Square sq) {
+        psq += psqt::table[piece][sq];
+        add_material(piece);
+    }
 
-        // Clamp game phase to a valid range
-        this->game_phase = std::max(0, std::min(this->game_phase, util::TOTAL_PHASE));
+    inline void remove_from_accumulators(chess::Piece piece, chess::Square sq) {
+        psq -= psqt::table[piece][sq];
+        remove_material(piece);
     }
 
-    void compute_pins_and_checks();
+    // Recomputes the incremental terms from the bitboards, used when a position is set up
+    void refresh_accumulators();
+
+    void compute_checks();      // after every move
+    void compute_pins() const;  // on demand, see pinned_pieces()
+    void compute_check_info() const; // on demand, see check_squares()
+    void compute_threats(chess::Color c) const; // on demand, see attacks_by()
 
     //Assumes 0-Based indexing of the board, a1 = 0 (from bottom left). 0-based indexing for rank and files too
     inline chess::Square get_square_from_rank_file(int8_t rank, int8_t file) { return (chess::Square)(8 * rank + file); }
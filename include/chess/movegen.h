@@ -4,13 +4,47 @@
 #include "bitboard.h"
 #include <vector>
 namespace MoveGen {
-    extern std::vector<chess::Move> moveList;
+    // Which moves to generate. All of them are strictly legal.
+    enum GenType {
+        CAPTURES,     // captures, en passant and capture-promotions
+        QUIETS,       // everything else: pushes, quiet promotions, castling
+        EVASIONS,     // every legal move while in check
+        QUIET_CHECKS, // non-capture, non-promotion moves that give check (direct or discovered)
+        ALL           // CAPTURES + QUIETS
+    };
 
-    void generate_pawn_moves(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly);
-    void generate_knight_moves(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly);
-    void generate_king_moves(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly);
-    void generate_orthogonal_sliders_moves(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly);
-    void generate_diagonal_sliders_moves(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly);
+    // "target" holds the destinations allowed for this GenType, already narrowed to the check evasions.
+    // The king computes its own targets since it is never bound by the evasion mask.
+    // Us is the side to move: each side gets its own code with constant directions and masks.
+    template<chess::Color Us, GenType T> void generate_pawn_moves(const Board& B, chess::MoveList& moveList, uint64_t target);
+    template<chess::Color Us, GenType T> void generate_knight_moves(const Board& B, chess::MoveList& moveList, uint64_t target);
+    template<chess::Color Us, GenType T> void generate_king_moves(const Board& B, chess::MoveList& moveList);
+    template<chess::Color Us, GenType T> void generate_orthogonal_sliders_moves(const Board& B, chess::MoveList& moveList, uint64_t target);
+    template<chess::Color Us, GenType T> void generate_diagonal_sliders_moves(const Board& B, chess::MoveList& moveList, uint64_t target);
 
-    void init(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly);
+    template<chess::Color Us, GenType T> void generate(const Board& B, chess::MoveList& moveList);
+
+    // Dispatches on the side to move once
+    template<GenType T> inline void generate(const Board& B, chess::MoveList& moveList) {
+        if (B.white_to_move) generate<chess::WHITE, T>(B, moveList);
+        else generate<chess::BLACK, T>(B, moveList);
+    }
+
+    // All legal moves, or only the captures
+    void init(const Board& B, chess::MoveList& moveList, bool capturesOnly);
+
+    // Could the generator have produced this move in this position? Used to trust moves
+    // from the transposition table and killers without generating first.
+    bool is_legal(const Board& B, const chess::Move& m);
 };
+
+// The generators live in their own translation units: instantiate them for both sides and every GenType
+#define MOVEGEN_INSTANTIATE_SIDE(fn, C, ...) \
+    template void MoveGen::fn<C, MoveGen::CAPTURES>(__VA_ARGS__); \
+    template void MoveGen::fn<C, MoveGen::QUIETS>(__VA_ARGS__); \
+    template void MoveGen::fn<C, MoveGen::EVASIONS>(__VA_ARGS__); \
+    template void MoveGen::fn<C, MoveGen::QUIET_CHECKS>(__VA_ARGS__); \
+    template void MoveGen::fn<C, MoveGen::ALL>(__VA_ARGS__);
+#define MOVEGEN_INSTANTIATE(fn, ...) \
+    MOVEGEN_INSTANTIATE_SIDE(fn, chess::WHITE, __VA_ARGS__) \
+    MOVEGEN_INSTANTIATE_SIDE(fn, chess::BLACK, __VA_ARGS__)
@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * @file psqt.h
+ * @brief Material + piece-square values that Board keeps up to date incrementally.
+ *
+ * The values and the table are defined in psqt.cpp, inside the chess layer, so the
+ * board links without the engine. The evaluation reads the sum from Board::psq.
+ */
+
+#include <array>
+#include <cstdint>
+#include "types.h"
+
+namespace psqt
+{
+    // A middlegame and an endgame value packed into one integer, so a single add updates both.
+    // The endgame half sits in the upper 16 bits; each half must stay within int16_t.
+    using Score = int32_t;
+
+    constexpr Score make_score(int mg, int eg) { return (Score)((uint32_t)eg << 16) + mg; }
+
+    // The +0x8000 undoes the borrow a negative middlegame half takes from the endgame half
+    constexpr int eg_value(Score s) { return int16_t(uint16_t(uint32_t(s + 0x8000) >> 16)); }
+    constexpr int mg_value(Score s) { return int16_t(uint16_t(uint32_t(s))); }
+
+    // [piece][square]: material + PST, positive for White, negative for Black (looked up mirrored)
+    extern const std::array<std::array<Score, chess::SQUARE_NB>, 16> table;
+}
@@ -10,6 +10,8 @@
  * dependencies between other modules.
  */
 
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
@@ -103,7 +105,7 @@ constexpr PieceType type_of(Piece p) {
 // Helper function to get the Color of a Piece
 constexpr Color color_of(Piece p) {
     if (p == NO_PIECE) return COLOR_NONE;
-    return Color(p & colorMask); // 4th bit = 0 -> White, 1 -> Black
+    return Color((p & colorMask) >> 3); // 4th bit = 0 -> White, 1 -> Black
 }
 
 // Helper function to construct a Piece from a PieceType and Color
@@ -179,26 +181,53 @@ struct Move {   //          LSB                          MSB
     bool is_null() const { return m == 0; }
 };
 
+// No legal chess position has more than 218 moves.
+constexpr int MAX_MOVES = 256;
+
+// Fixed-capacity move list on the stack, so generating moves never allocates.
+// Mirrors the parts of std::vector the generators and their callers use.
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int count = 0;
+
+    void push_back(const Move& mv) { moves[count++] = mv; }
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move& operator[](size_t i) { return moves[i]; }
+    const Move& operator[](size_t i) const { return moves[i]; }
+
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+
+    // Removes [first, last), keeping the order of the remaining moves.
+    Move* erase(Move* first, Move* last) {
+        Move* new_end = first;
+        for (Move* it = last; it != end(); ++it) *new_end++ = *it;
+        count = (int)(new_end - moves);
+        return first;
+    }
+};
+
 // ---------- Minimal undo record (compact) ----------
+// Only what make_move cannot reverse on its own. Material and phase are undone from the
+// captured and promoted pieces; double_check and the check mask follow from checks. 32 bytes.
 struct Undo {
-    uint64_t zobrist_before;      // full hash
+    uint64_t zobrist_before;      // full hash, also scanned for repetitions
+    uint64_t pinned;              // may still be Board::PINS_UNKNOWN
+    uint64_t checks;              // squares of checking pieces
+    int32_t psq;                  // packed psqt::Score, fills what would be padding
     uint16_t captured_piece_and_halfmove; 
         // lower 4 bits: captured piece code
         // upper 12 bits: halfmove clock (halfmove clock <= 50)
     int8_t prev_en_passant_sq;    // -1 if none
     uint8_t prev_castle_rights;   // 4-bit mask
-    int8_t promoted_to;           // 0 if none 
-    int8_t prev_white_king_sq;    // for incremental king position restore
-    int8_t prev_black_king_sq;
-    uint64_t pinned;         // single pass using ray attacks
-    uint64_t checks;       // squares of checking pieces
-    int32_t game_phase;
-    bool double_check;
-    uint64_t check_mask; // rays + checker squares
     Undo() = default;
 };
 
-
 //Will review later
 //-----------------------------------------------------------------------------
 // AI & EVALUATION TYPES
@@ -241,5 +270,37 @@ const int MATE_SCORE = 30000;
 // Board and game constants
 const int MAX_GAME_MOVES = 1024; // Used for static move arrays
 const int MAX_PLY = 128;         // Max search depth
+const int MAX_UNDO = MAX_GAME_MOVES + MAX_PLY; // Game history plus the deepest search line
+
+// Fixed-capacity undo history inside Board, so make_move never reallocates.
+// Copies only the entries in use, which keeps copying a Board cheap.
+struct UndoStack {
+    Undo entries[MAX_UNDO];
+    int count = 0;
+
+    UndoStack() = default;
+    UndoStack(const UndoStack& other) : count(other.count) {
+        for (int i = 0; i < count; ++i) entries[i] = other.entries[i];
+    }
+    UndoStack& operator=(const UndoStack& other) {
+        count = other.count;
+        for (int i = 0; i < count; ++i) entries[i] = other.entries[i];
+        return *this;
+    }
+
+    void push_back(const Undo& undo) {
+        assert(count < MAX_UNDO);
+        entries[count++] = undo;
+    }
+    void pop_back() { --count; }
+    Undo& back() { return entries[count - 1]; }
+    const Undo& back() const { return entries[count - 1]; }
+    void clear() { count = 0; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Undo& operator[](size_t i) { return entries[i]; }
+    const Undo& operator[](size_t i) const { return entries[i]; }
+};
 
 } // namespace chess
\ No newline at end of file
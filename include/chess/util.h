@@ -97,6 +97,9 @@ namespace util
         0  // KING (has no phase value)
     };
 
+    // Piece values used by the static exchange evaluation, indexed by PieceType
+    constexpr int see_values[] = {0, 100, 320, 330, 500, 900, 0};
+
     // Takes in a square and returns a square
     inline chess::Square shift_square(chess::Square square, chess::Direction dir)
     {
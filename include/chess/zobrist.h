@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 
 // Forward-declaration of Board
@@ -15,24 +16,30 @@ public:
     static uint64_t calculate_zobrist_hash(const Board& B);
 
     /**
-     * @brief Initializes the static Zobrist key arrays. 
-     * MUST be called once at program startup.
+     * @brief The en passant part of the hash: the file key if a pawn of the side to move
+     * could capture en passant, 0 otherwise.
      */
-    static void init_zobrist_keys();
+    static uint64_t en_passant_key(const Board& B);
+
+    /**
+     * @brief The keys are compile-time constants; nothing is left to initialize.
+     * Kept so existing callers keep working.
+     */
+    static void init_zobrist_keys() {}
 
     // --- STATIC MEMBER VARIABLES (DECLARATIONS) ---
-    // These tell the compiler that these variables exist.
-    // The memory for them is allocated in zobrist.cpp.
+    // Polyglot's random64 table split up by purpose.
+    // They are defined as constexpr in zobrist.cpp.
     
     // [piece_index][square]
-    static uint64_t piecesArray[12][64];
+    static const std::array<std::array<uint64_t, 64>, 12> piecesArray;
     
     // [0=WK, 1=WQ, 2=BK, 3=BQ]
-    static uint64_t castlingRights[4];
+    static const std::array<uint64_t, 4> castlingRights;
     
     // [file]
-    static uint64_t enPassantFile[8];
+    static const std::array<uint64_t, 8> enPassantFile;
     
     // Hashed if it's white's turn
-    static uint64_t sideToMove;
+    static const uint64_t sideToMove;
 };
\ No newline at end of file
@@ -1,19 +1,48 @@
 #pragma once
 
-#include <vector>
 #include <algorithm>
 #include "chess/movegen.h"
 
 class Search;
+struct SearchStack;
 
+/**
+ * @brief Hands out the moves of a node one at a time, best first.
+ *
+ * Moves are produced in stages and each stage is only generated once the previous
+ * one is used up, so a cutoff on the hash move costs no move generation at all:
+ *   hash move -> good captures -> killers -> quiets -> bad captures
+ * In qsearch only the hash move (if it is a capture) and the captures are produced,
+ * unless the side to move is in check: then every evasion is produced.
+ * Within a stage the best remaining move is selected on demand instead of sorting.
+ */
 class MoveOrderer {
 public:
-    MoveOrderer(const Board& b, int ply, Search& s, bool captureOnly);
+    // ss may be null where there are no killers (qsearch, ProbCut)
+    MoveOrderer(const Board& b, const SearchStack* ss, Search& s, const chess::Move& tt_move, bool captureOnly);
     chess::Move get_next_move();
 
 private:
-    void score_moves(const Board& B, int ply, Search& s, std::vector<chess::Move>& moveList, const chess::Move& best_move);
-    
-    std::vector<std::pair<int, chess::Move>> scored_moves;
+    enum Stage { TT_MOVE, GEN_CAPTURES, GOOD_CAPTURES, KILLER_1, KILLER_2, GEN_QUIETS, QUIETS, BAD_CAPTURES,
+                 EVASION_TT_MOVE, GEN_EVASIONS, EVASIONS, DONE };
+
+    void score_captures();
+    void score_quiets();
+    void score_evasions();
+    chess::Move select_best();
+    bool is_special(const chess::Move& m) const; // already handed out by the hash move or killer stages
+
+    const Board& B;
+    Search& s;
+    chess::Move tt_move;
+    chess::Move killers[2];
+    bool captures_only;
+    int stage = TT_MOVE;
+
+    chess::MoveList moves;
+    int scores[chess::MAX_MOVES];
     size_t current_move = 0;
-};
\ No newline at end of file
+
+    chess::MoveList bad_captures;
+    size_t current_bad_capture = 0;
+};
@@ -15,6 +15,14 @@ struct EngineOptions {
     int hash_size_mb = 128;
     int thread_count = 1;
     bool own_book = true;
+    int move_overhead_ms = 30; // reserved per move for GUI / network latency
+
+    // Forward pruning, switchable to measure each one on the bench
+    bool reverse_futility_pruning = true;
+    bool futility_pruning = true;
+    bool razoring = true;
+    bool late_move_pruning = true;
+    bool probcut = true;
     // Add other UCI options like "Ponder", "Contempt", etc.
 };
 
@@ -3,19 +3,81 @@
 #include <atomic>
 #include <cstdint>
 #include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <vector>
 #include "chess/board.h"
 #include "chess/types.h"
 #include "chess/movegen.h"
 #include "transposition.h"
+#include "engine/options.h"
+#include "engine/time.h"
 #include "utils/threadpool.h"
 
 #define DRAW_EVAL 0
 #define CHECKMATE_EVAL -(int)1e7
 #define NEG_INFINITY_EVAL (-(int)1e9)
 #define MAX_PLY 64
+#define MAX_HISTORY 16384
+#define QSEARCH_DELTA_MARGIN 200
+#define PROBCUT_MARGIN 200
 
 class MoveOrderer;
 
+/**
+ * @brief What one ply of a search thread knows about its node.
+ * The frames live in a per-thread array with two sentinel frames in front, so
+ * (ss - 1) and (ss - 2) can always be read.
+ */
+struct SearchStack {
+    int64_t static_eval = NEG_INFINITY_EVAL; // NEG_INFINITY_EVAL when in check
+    chess::Move current_move{};              // move being searched; null for a null move
+    chess::Move excluded_move{};             // left out by the singular extension search
+    chess::Move killers[2]{};
+    bool in_check = false;
+    bool improving = false;                  // static eval better than two plies ago
+};
+
+#define SEARCH_STACK_SIZE (MAX_PLY + 3)
+
+// Any score at least this far from zero is a forced mate, CHECKMATE_EVAL + ply.
+inline bool is_mate_score(int64_t score) {
+    return std::llabs(score) >= -(int64_t)CHECKMATE_EVAL - MAX_PLY;
+}
+
+// Number of plies until mate for a mate score (from either side's perspective).
+inline int mate_distance_plies(int64_t score) {
+    return (int)(-(int64_t)CHECKMATE_EVAL - std::llabs(score));
+}
+
+// The TT stores mate scores as distance from the stored node, not from the root,
+// so a mate found through a transposition keeps its correct distance.
+inline int64_t score_to_tt(int64_t score, int ply) {
+    if (!is_mate_score(score)) return score;
+    return score > 0 ? score + ply : score - ply;
+}
+
+inline int64_t score_from_tt(int64_t score, int ply) {
+    if (!is_mate_score(score)) return score;
+    return score > 0 ? score - ply : score + ply;
+}
+
+/**
+ * @brief Everything a UCI "go" command can ask for.
+ * A value of zero means the limit was not given.
+ */
+struct SearchLimits {
+    int depth = 0;
+    uint64_t nodes = 0;
+    int mate = 0;               // find a mate in this many moves
+    int movetime = 0;
+    int wtime = 0, btime = 0;
+    int winc = 0, binc = 0;
+    int movestogo = 0;
+    bool infinite = false;      // search until "stop", never report bestmove on our own
+    std::vector<chess::Move> searchmoves; // restrict the root to these moves
+};
+
 class Search {
 public:
     // Constructor
@@ -23,24 +85,40 @@ public:
 
     /**
      * @brief The main entry point to begin a search.
-     * This will be expanded later to handle time management and iterative deepening.
-     * For now, it performs a simple fixed-depth search.
+     * Runs iterative deepening until one of the limits is hit or stopSearch is raised.
      * @param board The starting position for the search.
-     * @param depth The fixed depth to search to.
+     * @param limits The limits parsed from the "go" command.
      * @return The best move found for the current position.
      */
-    chess::Move start_search(Board& board, int depth, int movetime, int wtime, int btime, int winc, int binc);
+    chess::Move start_search(Board& board, const SearchLimits& limits);
+
+    // Forgets everything learned so far: transposition table, killers and history.
+    void clear();
 
     // Publicly accessible search statistics
     uint64_t nodes_searched;
-    chess::Move killer_moves[MAX_PLY][2];
+    uint64_t node_limit = 0;     // 0 = unlimited
+    uint64_t aspiration_fail_lows = 0;  // root re-searches of the last search
+    uint64_t aspiration_fail_highs = 0;
+    bool use_thread_pool = true; // split root moves over the pool (non-deterministic)
+    int root_depth = 0;          // depth of the current iteration
     chess::Move pv_table[MAX_PLY][MAX_PLY];
-    int history_scores[15][64]{}; // [piece][dest_sq]
+    std::atomic<uint32_t> stack_generation{0}; // bumped by clear() to reset the per-thread search stacks
+    int history_scores[15][64]{}; // [piece][dest_sq], within +-MAX_HISTORY
+    int lmr_reductions[64][64];   // [depth][move number], filled in the constructor
     static int evaluate(const Board& b);
     TranspositionTable TT;
     std::atomic<bool> stopSearch;
     ThreadPool pool;
     std::chrono::steady_clock::time_point searchEndTime; 
+    TimeManager time_manager;
+
+    // Raises stopSearch once the node budget or the clock runs out.
+    // The clock is only read every 1024 nodes.
+    inline void check_limits() {
+        if (node_limit && nodes_searched >= node_limit) stopSearch.store(true);
+        if ((nodes_searched & 1023) == 0 && std::chrono::steady_clock::now() >= searchEndTime) stopSearch.store(true);
+    }
 
 private:
     /**
@@ -48,10 +126,18 @@ private:
      * @param board The current board state.
      * @param depth Remaining depth to search.
      * @param alpha The lower bound for the score (best score for maximizing player).
+     * @param ss The search stack frame of this ply.
      * @param beta The upper bound for the score (best score for minimizing player).
+     * @param cut_node Whether a beta cutoff is expected here.
      * @return The evaluation of the position from the side-to-move's perspective.
      */
-    int64_t negamax(Board& board, int depth, int ply, int64_t alpha, int64_t beta);
+    int64_t negamax(Board& board, SearchStack* ss, int depth, int ply, int64_t alpha, int64_t beta, bool cut_node = false);
+
+    // Searches one root move on the calling thread's stack and returns its score for the root side.
+    int64_t search_root_move(const Position& root, std::shared_ptr<const GameHistory> history, chess::Move move, int depth, int64_t alpha, int64_t beta);
+
+    // The root frame (ply 0) of the calling thread's search stack.
+    SearchStack* thread_stack();
 
     /**
      * @brief Quiescence search to stabilize the evaluation at horizon nodes.
@@ -70,15 +156,18 @@ private:
      * @return The score in centipawns. Positive is good for the current player.
      */
 
-    inline void update_killers(int ply, const chess::Move& move) {
-        if (killer_moves[ply][0].m != move.m) {
-            killer_moves[ply][1] = killer_moves[ply][0];
-            killer_moves[ply][0] = move;
+    inline void update_killers(SearchStack* ss, const chess::Move& move) {
+        if (ss->killers[0].m != move.m) {
+            ss->killers[1] = ss->killers[0];
+            ss->killers[0] = move;
         }
     }
 
-    inline void update_history(const Board& B, const chess::Move& move, int depth) {
-        history_scores[B.board_array[move.from()]][move.to()] += depth*depth;  //depth * depth since we want cutoffs near the root
+    // Moves the score towards +-MAX_HISTORY, slower the closer it already is, so it never overflows
+    // and recent results outweigh old ones.
+    inline void update_history(const Board& B, const chess::Move& move, int bonus) {
+        int& h = history_scores[B.board_array[move.from()]][move.to()];
+        h += bonus - h * std::abs(bonus) / MAX_HISTORY;
     }
 
 };
\ No newline at end of file
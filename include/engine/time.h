@@ -0,0 +1,82 @@
+#pragma once
+
+/**
+ * @file time.h
+ * @brief Decides how long the engine may think about a move.
+ *
+ * Every search gets two deadlines:
+ *  - the soft limit, after which no new iteration is started. It is scaled up
+ *    when the best move keeps changing or the score drops, and down when the
+ *    best move has been stable for several iterations.
+ *  - the hard limit, at which a running search is aborted. It never exceeds
+ *    the clock minus the move overhead.
+ *
+ * The manager also keeps running statistics over a whole session (e.g. a
+ * self-play run) so time usage and time losses can be inspected afterwards.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include "chess/types.h"
+
+struct SearchLimits;
+
+class TimeManager {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Computes the deadlines for a search that starts now.
+     * @param limits The limits parsed from the "go" command.
+     * @param white_to_move Selects our clock.
+     * @param game_phase Board::game_phase, 24 (opening) down to 0 (bare kings).
+     * @param move_overhead_ms Latency reserved for the GUI / network per move.
+     */
+    void init(const SearchLimits& limits, bool white_to_move, int game_phase, int move_overhead_ms);
+
+    // Is the search governed by a clock at all? (false for depth/nodes/mate/infinite searches)
+    bool is_managed() const { return managed; }
+
+    Clock::time_point hard_deadline() const;
+    int64_t elapsed_ms() const;
+    int64_t soft_limit_ms() const { return soft_ms; }
+    int64_t hard_limit_ms() const { return hard_ms; }
+
+    /**
+     * @brief Called after every completed iteration.
+     * @return true if another iteration is not worth starting.
+     */
+    bool should_stop(int depth, const chess::Move& best_move, int64_t score);
+
+    // Records the time spent on the move just searched in the session statistics.
+    void finish_move();
+
+    // Marks the start of a new game for the session statistics.
+    void new_game();
+
+    uint64_t games_played() const { return games; }
+
+    // Prints the session statistics as a UCI "info string".
+    void report(std::ostream& out) const;
+
+private:
+    bool managed = false;
+    Clock::time_point start_time{};
+    int64_t soft_ms = 0;
+    int64_t hard_ms = 0;
+    int64_t clock_ms = 0;          // our remaining time when the search started (0 if unknown)
+    int64_t overhead_ms = 0;
+
+    // Iteration-to-iteration state for the stability heuristics.
+    chess::Move last_best_move{};
+    int best_move_stable_iterations = 0;
+    int64_t last_score = 0;
+
+    // Session statistics.
+    uint64_t moves_timed = 0;
+    int64_t total_time_ms = 0;
+    uint64_t games = 0;
+    uint64_t games_lost_on_time = 0;
+    bool flagged_this_game = false;
+};
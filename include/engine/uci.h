@@ -4,6 +4,8 @@
 #include <vector>
 #include <thread>
 #include <fstream>
+#include <memory>
+#include <chrono>
 #include "chess/board.h"
 #include "engine/search.h"
 #include "chess/movegen.h"
@@ -13,6 +15,8 @@ class OpeningBook;
 
 chess::Move parse_move(Board& board, const std::string& move_string);
 
-void start_search_thread(Board board, Search* search_agent, int depth, int movetime, int wtime, int btime, int winc, int binc);
+void start_search_thread(Position position, std::shared_ptr<const GameHistory> history, Search* search_agent, SearchLimits limits);
+
+void bench(Search& search_agent, int depth);
 
 void uci(Board &board, Search& search_agent, std::thread& search_thread, OpeningBook& white_book, OpeningBook& black_book);
\ No newline at end of file
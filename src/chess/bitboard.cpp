@@ -1,50 +1,29 @@
-#include "chess/movegen.h"
-#include "chess/types.h"
-#include "chess/zobrist.h"
-#include <iomanip>
+#include "chess/bitboard.h"
 
 /**
  * @file uint64_t.cpp
- * @brief Implements the initialization of all pre-computed uint64_t data.
+ * @brief Defines all pre-computed uint64_t data.
  *
- * This file contains the definitions for the attack tables and the logic
- * for the one-time `init()` function. This function populates the tables for
- * pawn, knight, and king attacks, and crucially, generates the complete set of
- * attacks for rooks and bishops using the Magic uint64_t technique.
+ * Pawn, knight and king attacks, the Between/Rays/Line tables and the magic
+ * lookup descriptors are built by the compiler (constexpr), so they cost
+ * nothing at run time. The rook and bishop attack sets are too large for
+ * compile-time evaluation and are filled in once while the program is
+ * loaded, before main() runs.
  */
 
 namespace chess
 {
 
-    //-----------------------------------------------------------------------------
-    // TABLE DEFINITIONS
-    //
-    // These are the actual memory allocations for the tables declared as 'extern'
-    // in the header file.
-    //-----------------------------------------------------------------------------
-
-    uint64_t PawnAttacks[COLOR_NB][SQUARE_NB];
-    uint64_t KnightAttacks[SQUARE_NB];
-    uint64_t KingAttacks[SQUARE_NB];
-
-    Magic RookMagics[SQUARE_NB];
-    Magic BishopMagics[SQUARE_NB];
-    uint64_t RookAttacks[SQUARE_NB][4096];
-    uint64_t BishopAttacks[SQUARE_NB][512];
-
-    uint64_t files[] = {util::FileA, util::FileB, util::FileC, util::FileD, util::FileE, util::FileF, util::FileG, util::FileH};
-    uint64_t ranks[] = {util::Rank1, util::Rank2, util::Rank3, util::Rank4, util::Rank5, util::Rank6, util::Rank7, util::Rank8};
-
     //-----------------------------------------------------------------------------
     // ANONYMOUS NAMESPACE FOR HELPER FUNCTIONS
     //
-    // These functions are only used within this file to perform the one-time
-    // initialization of the attack tables.
+    // These functions are only used within this file to build the tables,
+    // nearly all of them at compile time.
     //-----------------------------------------------------------------------------
     namespace
     {
 
-        const uint64_t magicmoves_r_magics[64] = {
+        constexpr uint64_t magicmoves_r_magics[64] = {
             0x0080001020400080ULL, 0x0040001000200040ULL, 0x0080081000200080ULL, 0x0080040800100080ULL,
             0x0080020400080080ULL, 0x0080010200040080ULL, 0x0080008001000200ULL, 0x0080002040800100ULL,
             0x0000800020400080ULL, 0x0000400020005000ULL, 0x0000801000200080ULL, 0x0000800800100080ULL,
@@ -62,7 +41,7 @@ namespace chess
             0x00FFFCDDFCED714AULL, 0x007FFCDDFCED714AULL, 0x003FFFCDFFD88096ULL, 0x0000040810002101ULL,
             0x0001000204080011ULL, 0x0001000204000801ULL, 0x0001000082000401ULL, 0x0001FFFAABFAD1A2ULL};
 
-        const uint64_t magicmoves_b_magics[64] = {
+        constexpr uint64_t magicmoves_b_magics[64] = {
             0x0002020202020200ULL, 0x0002020202020000ULL, 0x0004010202000000ULL, 0x0004040080000000ULL,
             0x0001104000000000ULL, 0x0000821040000000ULL, 0x0000410410400000ULL, 0x0000104104104000ULL,
             0x0000040404040400ULL, 0x0000020202020200ULL, 0x0000040102020000ULL, 0x0000040400800000ULL,
@@ -80,7 +59,7 @@ namespace chess
             0x0000104104104000ULL, 0x0000002082082000ULL, 0x0000000020841000ULL, 0x0000000000208800ULL,
             0x0000000010020200ULL, 0x0000000404080200ULL, 0x0000040404040400ULL, 0x0002020202020200ULL};
 
-        const uint8_t magicmoves_r_shifts[64] =
+        constexpr uint8_t magicmoves_r_shifts[64] =
             {
                 52, 53, 53, 53, 53, 53, 53, 52,
                 53, 54, 54, 54, 54, 54, 54, 53,
@@ -91,7 +70,7 @@ namespace chess
                 53, 54, 54, 54, 54, 54, 54, 53,
                 53, 54, 54, 53, 53, 53, 53, 53};
 
-        const uint8_t magicmoves_b_shifts[64] =
+        constexpr uint8_t magicmoves_b_shifts[64] =
             {
                 58, 59, 59, 59, 59, 59, 59, 58,
                 59, 59, 59, 59, 59, 59, 59, 59,
@@ -102,7 +81,7 @@ namespace chess
                 59, 59, 59, 59, 59, 59, 59, 59,
                 58, 59, 59, 59, 59, 59, 59, 58};
 
-        const uint64_t rook_masks[64] = {
+        constexpr uint64_t rook_masks[64] = {
             0x01010101010101FEULL, 0x02020202020202FDULL, 0x04040404040404FBULL, 0x08080808080808F7ULL,
             0x10101010101010EFULL, 0x20202020202020DFULL, 0x40404040404040BFULL, 0x808080808080807FULL,
             0x010101010101FE01ULL, 0x020202020202FD02ULL, 0x040404040404FB04ULL, 0x080808080808F708ULL,
@@ -120,7 +99,7 @@ namespace chess
             0xFE01010101010101ULL, 0xFD02020202020202ULL, 0xFB04040404040404ULL, 0xF708080808080808ULL,
             0xEF10101010101010ULL, 0xDF20202020202020ULL, 0xBF40404040404040ULL, 0x7F80808080808080ULL};
 
-        const uint64_t bishop_masks[64] = {
+        constexpr uint64_t bishop_masks[64] = {
             0x40201008040200ULL, 0x402010080500ULL, 0x4020110a00ULL, 0x41221400ULL,
             0x102442800ULL, 0x10204085000ULL, 0x1020408102000ULL, 0x2040810204000ULL,
             0x20100804020002ULL, 0x40201008050005ULL, 0x4020110a000aULL, 0x4122140014ULL,
@@ -139,347 +118,193 @@ namespace chess
             0x2040810204000ULL, 0x5081020400000ULL, 0xa112040000000ULL, 0x14224100000000ULL,
             0x28440201000000ULL, 0x50080402010000ULL, 0x20100804020100ULL, 0x40201008040201ULL};
 
-        // Pre-computed magic numbers for rooks and bishops. These are standard values.
-        // Initialize the ROOK_MAGIC_INIT array of structs
-        const Magic ROOK_MAGICS_INIT[64] = {
-            {rook_masks[0], magicmoves_r_magics[0], magicmoves_r_shifts[0]},
-            {rook_masks[1], magicmoves_r_magics[1], magicmoves_r_shifts[1]},
-            {rook_masks[2], magicmoves_r_magics[2], magicmoves_r_shifts[2]},
-            {rook_masks[3], magicmoves_r_magics[3], magicmoves_r_shifts[3]},
-            {rook_masks[4], magicmoves_r_magics[4], magicmoves_r_shifts[4]},
-            {rook_masks[5], magicmoves_r_magics[5], magicmoves_r_shifts[5]},
-            {rook_masks[6], magicmoves_r_magics[6], magicmoves_r_shifts[6]},
-            {rook_masks[7], magicmoves_r_magics[7], magicmoves_r_shifts[7]},
-            {rook_masks[8], magicmoves_r_magics[8], magicmoves_r_shifts[8]},
-            {rook_masks[9], magicmoves_r_magics[9], magicmoves_r_shifts[9]},
-            {rook_masks[10], magicmoves_r_magics[10], magicmoves_r_shifts[10]},
-            {rook_masks[11], magicmoves_r_magics[11], magicmoves_r_shifts[11]},
-            {rook_masks[12], magicmoves_r_magics[12], magicmoves_r_shifts[12]},
-            {rook_masks[13], magicmoves_r_magics[13], magicmoves_r_shifts[13]},
-            {rook_masks[14], magicmoves_r_magics[14], magicmoves_r_shifts[14]},
-            {rook_masks[15], magicmoves_r_magics[15], magicmoves_r_shifts[15]},
-            {rook_masks[16], magicmoves_r_magics[16], magicmoves_r_shifts[16]},
-            {rook_masks[17], magicmoves_r_magics[17], magicmoves_r_shifts[17]},
-            {rook_masks[18], magicmoves_r_magics[18], magicmoves_r_shifts[18]},
-            {rook_masks[19], magicmoves_r_magics[19], magicmoves_r_shifts[19]},
-            {rook_masks[20], magicmoves_r_magics[20], magicmoves_r_shifts[20]},
-            {rook_masks[21], magicmoves_r_magics[21], magicmoves_r_shifts[21]},
-            {rook_masks[22], magicmoves_r_magics[22], magicmoves_r_shifts[22]},
-            {rook_masks[23], magicmoves_r_magics[23], magicmoves_r_shifts[23]},
-            {rook_masks[24], magicmoves_r_magics[24], magicmoves_r_shifts[24]},
-            {rook_masks[25], magicmoves_r_magics[25], magicmoves_r_shifts[25]},
-            {rook_masks[26], magicmoves_r_magics[26], magicmoves_r_shifts[26]},
-            {rook_masks[27], magicmoves_r_magics[27], magicmoves_r_shifts[27]},
-            {rook_masks[28], magicmoves_r_magics[28], magicmoves_r_shifts[28]},
-            {rook_masks[29], magicmoves_r_magics[29], magicmoves_r_shifts[29]},
-            {rook_masks[30], magicmoves_r_magics[30], magicmoves_r_shifts[30]},
-            {rook_masks[31], magicmoves_r_magics[31], magicmoves_r_shifts[31]},
-            {rook_masks[32], magicmoves_r_magics[32], magicmoves_r_shifts[32]},
-            {rook_masks[33], magicmoves_r_magics[33], magicmoves_r_shifts[33]},
-            {rook_masks[34], magicmoves_r_magics[34], magicmoves_r_shifts[34]},
-            {rook_masks[35], magicmoves_r_magics[35], magicmoves_r_shifts[35]},
-            {rook_masks[36], magicmoves_r_magics[36], magicmoves_r_shifts[36]},
-            {rook_masks[37], magicmoves_r_magics[37], magicmoves_r_shifts[37]},
-            {rook_masks[38], magicmoves_r_magics[38], magicmoves_r_shifts[38]},
-            {rook_masks[39], magicmoves_r_magics[39], magicmoves_r_shifts[39]},
-            {rook_masks[40], magicmoves_r_magics[40], magicmoves_r_shifts[40]},
-            {rook_masks[41], magicmoves_r_magics[41], magicmoves_r_shifts[41]},
-            {rook_masks[42], magicmoves_r_magics[42], magicmoves_r_shifts[42]},
-            {rook_masks[43], magicmoves_r_magics[43], magicmoves_r_shifts[43]},
-            {rook_masks[44], magicmoves_r_magics[44], magicmoves_r_shifts[44]},
-            {rook_masks[45], magicmoves_r_magics[45], magicmoves_r_shifts[45]},
-            {rook_masks[46], magicmoves_r_magics[46], magicmoves_r_shifts[46]},
-            {rook_masks[47], magicmoves_r_magics[47], magicmoves_r_shifts[47]},
-            {rook_masks[48], magicmoves_r_magics[48], magicmoves_r_shifts[48]},
-            {rook_masks[49], magicmoves_r_magics[49], magicmoves_r_shifts[49]},
-            {rook_masks[50], magicmoves_r_magics[50], magicmoves_r_shifts[50]},
-            {rook_masks[51], magicmoves_r_magics[51], magicmoves_r_shifts[51]},
-            {rook_masks[52], magicmoves_r_magics[52], magicmoves_r_shifts[52]},
-            {rook_masks[53], magicmoves_r_magics[53], magicmoves_r_shifts[53]},
-            {rook_masks[54], magicmoves_r_magics[54], magicmoves_r_shifts[54]},
-            {rook_masks[55], magicmoves_r_magics[55], magicmoves_r_shifts[55]},
-            {rook_masks[56], magicmoves_r_magics[56], magicmoves_r_shifts[56]},
-            {rook_masks[57], magicmoves_r_magics[57], magicmoves_r_shifts[57]},
-            {rook_masks[58], magicmoves_r_magics[58], magicmoves_r_shifts[58]},
-            {rook_masks[59], magicmoves_r_magics[59], magicmoves_r_shifts[59]},
-            {rook_masks[60], magicmoves_r_magics[60], magicmoves_r_shifts[60]},
-            {rook_masks[61], magicmoves_r_magics[61], magicmoves_r_shifts[61]},
-            {rook_masks[62], magicmoves_r_magics[62], magicmoves_r_shifts[62]},
-            {rook_masks[63], magicmoves_r_magics[63], magicmoves_r_shifts[63]},
-        };
-
-        const Magic BISHOP_MAGICS_INIT[64] = {
-            {bishop_masks[0], magicmoves_b_magics[0], magicmoves_b_shifts[0]},
-            {bishop_masks[1], magicmoves_b_magics[1], magicmoves_b_shifts[1]},
-            {bishop_masks[2], magicmoves_b_magics[2], magicmoves_b_shifts[2]},
-            {bishop_masks[3], magicmoves_b_magics[3], magicmoves_b_shifts[3]},
-            {bishop_masks[4], magicmoves_b_magics[4], magicmoves_b_shifts[4]},
-            {bishop_masks[5], magicmoves_b_magics[5], magicmoves_b_shifts[5]},
-            {bishop_masks[6], magicmoves_b_magics[6], magicmoves_b_shifts[6]},
-            {bishop_masks[7], magicmoves_b_magics[7], magicmoves_b_shifts[7]},
-            {bishop_masks[8], magicmoves_b_magics[8], magicmoves_b_shifts[8]},
-            {bishop_masks[9], magicmoves_b_magics[9], magicmoves_b_shifts[9]},
-            {bishop_masks[10], magicmoves_b_magics[10], magicmoves_b_shifts[10]},
-            {bishop_masks[11], magicmoves_b_magics[11], magicmoves_b_shifts[11]},
-            {bishop_masks[12], magicmoves_b_magics[12], magicmoves_b_shifts[12]},
-            {bishop_masks[13], magicmoves_b_magics[13], magicmoves_b_shifts[13]},
-            {bishop_masks[14], magicmoves_b_magics[14], magicmoves_b_shifts[14]},
-            {bishop_masks[15], magicmoves_b_magics[15], magicmoves_b_shifts[15]},
-            {bishop_masks[16], magicmoves_b_magics[16], magicmoves_b_shifts[16]},
-            {bishop_masks[17], magicmoves_b_magics[17], magicmoves_b_shifts[17]},
-            {bishop_masks[18], magicmoves_b_magics[18], magicmoves_b_shifts[18]},
-            {bishop_masks[19], magicmoves_b_magics[19], magicmoves_b_shifts[19]},
-            {bishop_masks[20], magicmoves_b_magics[20], magicmoves_b_shifts[20]},
-            {bishop_masks[21], magicmoves_b_magics[21], magicmoves_b_shifts[21]},
-            {bishop_masks[22], magicmoves_b_magics[22], magicmoves_b_shifts[22]},
-            {bishop_masks[23], magicmoves_b_magics[23], magicmoves_b_shifts[23]},
-            {bishop_masks[24], magicmoves_b_magics[24], magicmoves_b_shifts[24]},
-            {bishop_masks[25], magicmoves_b_magics[25], magicmoves_b_shifts[25]},
-            {bishop_masks[26], magicmoves_b_magics[26], magicmoves_b_shifts[26]},
-            {bishop_masks[27], magicmoves_b_magics[27], magicmoves_b_shifts[27]},
-            {bishop_masks[28], magicmoves_b_magics[28], magicmoves_b_shifts[28]},
-            {bishop_masks[29], magicmoves_b_magics[29], magicmoves_b_shifts[29]},
-            {bishop_masks[30], magicmoves_b_magics[30], magicmoves_b_shifts[30]},
-            {bishop_masks[31], magicmoves_b_magics[31], magicmoves_b_shifts[31]},
-            {bishop_masks[32], magicmoves_b_magics[32], magicmoves_b_shifts[32]},
-            {bishop_masks[33], magicmoves_b_magics[33], magicmoves_b_shifts[33]},
-            {bishop_masks[34], magicmoves_b_magics[34], magicmoves_b_shifts[34]},
-            {bishop_masks[35], magicmoves_b_magics[35], magicmoves_b_shifts[35]},
-            {bishop_masks[36], magicmoves_b_magics[36], magicmoves_b_shifts[36]},
-            {bishop_masks[37], magicmoves_b_magics[37], magicmoves_b_shifts[37]},
-            {bishop_masks[38], magicmoves_b_magics[38], magicmoves_b_shifts[38]},
-            {bishop_masks[39], magicmoves_b_magics[39], magicmoves_b_shifts[39]},
-            {bishop_masks[40], magicmoves_b_magics[40], magicmoves_b_shifts[40]},
-            {bishop_masks[41], magicmoves_b_magics[41], magicmoves_b_shifts[41]},
-            {bishop_masks[42], magicmoves_b_magics[42], magicmoves_b_shifts[42]},
-            {bishop_masks[43], magicmoves_b_magics[43], magicmoves_b_shifts[43]},
-            {bishop_masks[44], magicmoves_b_magics[44], magicmoves_b_shifts[44]},
-            {bishop_masks[45], magicmoves_b_magics[45], magicmoves_b_shifts[45]},
-            {bishop_masks[46], magicmoves_b_magics[46], magicmoves_b_shifts[46]},
-            {bishop_masks[47], magicmoves_b_magics[47], magicmoves_b_shifts[47]},
-            {bishop_masks[48], magicmoves_b_magics[48], magicmoves_b_shifts[48]},
-            {bishop_masks[49], magicmoves_b_magics[49], magicmoves_b_shifts[49]},
-            {bishop_masks[50], magicmoves_b_magics[50], magicmoves_b_shifts[50]},
-            {bishop_masks[51], magicmoves_b_magics[51], magicmoves_b_shifts[51]},
-            {bishop_masks[52], magicmoves_b_magics[52], magicmoves_b_shifts[52]},
-            {bishop_masks[53], magicmoves_b_magics[53], magicmoves_b_shifts[53]},
-            {bishop_masks[54], magicmoves_b_magics[54], magicmoves_b_shifts[54]},
-            {bishop_masks[55], magicmoves_b_magics[55], magicmoves_b_shifts[55]},
-            {bishop_masks[56], magicmoves_b_magics[56], magicmoves_b_shifts[56]},
-            {bishop_masks[57], magicmoves_b_magics[57], magicmoves_b_shifts[57]},
-            {bishop_masks[58], magicmoves_b_magics[58], magicmoves_b_shifts[58]},
-            {bishop_masks[59], magicmoves_b_magics[59], magicmoves_b_shifts[59]},
-            {bishop_masks[60], magicmoves_b_magics[60], magicmoves_b_shifts[60]},
-            {bishop_masks[61], magicmoves_b_magics[61], magicmoves_b_shifts[61]},
-            {bishop_masks[62], magicmoves_b_magics[62], magicmoves_b_shifts[62]},
-            {bishop_masks[63], magicmoves_b_magics[63], magicmoves_b_shifts[63]},
-        };
-
-        // Helper function to generate slider attacks "on the fly". This is used
-        // only once during initialization to populate the magic lookup tables.
-        uint64_t generate_attacks_on_the_fly(Square s, uint64_t blockers, int deltas[], int num_deltas)
+        constexpr bool on_board(int rank, int file) { return rank >= 0 && rank < 8 && file >= 0 && file < 8; }
+
+        constexpr int popcount(uint64_t bb)
+        {
+            int n = 0;
+            for (; bb; bb &= bb - 1)
+                ++n;
+            return n;
+        }
+
+        // Walks from s in one direction, including the first blocker, stopping at the edge
+        constexpr uint64_t slide(int s, uint64_t blockers, int dr, int df)
         {
             uint64_t attacks = util::Empty;
-            for (int i = 0; i < num_deltas; ++i)
+            int rank = s / 8 + dr, file = s % 8 + df;
+            while (on_board(rank, file))
             {
-                Square current_sq = s;
-                while (true)
-                {
-                    current_sq = Square(current_sq + deltas[i]);
-                    // Check for wrap-around or off-board
-                    if (current_sq < A1 || current_sq > H8 || square_distance(current_sq, Square(current_sq - deltas[i])) > 2)
-                    {
-                        break;
-                    }
-                    util::set_bit(attacks, current_sq);
-                    // Stop if we hit a blocking piece
-                    if (util::get_bit(blockers, current_sq))
-                    {
-                        break;
-                    }
-                }
+                const uint64_t bb = 1ULL << (rank * 8 + file);
+                attacks |= bb;
+                if (blockers & bb)
+                    break;
+                rank += dr;
+                file += df;
             }
             return attacks;
         }
 
-        // Generates rook attacks and masks for a given square
-        void init_rook_magics(Square s)
+        constexpr uint64_t rook_attacks_on_the_fly(int s, uint64_t blockers)
         {
-            RookMagics[s] = ROOK_MAGICS_INIT[s];
-            uint64_t edges = ((util::Rank1 | util::Rank8) & ~util::Rank[s]) | ((util::FileA | util::FileH) & ~util::File[s]);
-            RookMagics[s].mask &= (~edges);
-
-            uint64_t b = util::Empty;
-            int num_blockers = util::count_bits(RookMagics[s].mask);
-            for (int i = 0; i < (1 << num_blockers); ++i)
-            {
-                int deltas[] = {-8, -1, 1, 8};
-                uint64_t attacks = generate_attacks_on_the_fly(s, b, deltas, 4);
-                size_t magic_index = (b * RookMagics[s].magic) >> RookMagics[s].shift;
-                RookAttacks[s][magic_index] = attacks;
-                b = (b - RookMagics[s].mask) & RookMagics[s].mask; // Carry-rippler trick
-            }
+            return slide(s, blockers, 1, 0) | slide(s, blockers, -1, 0) | slide(s, blockers, 0, 1) | slide(s, blockers, 0, -1);
         }
 
-        // Generates bishop attacks and masks for a given square
-        void init_bishop_magics(Square s)
+        constexpr uint64_t bishop_attacks_on_the_fly(int s, uint64_t blockers)
         {
-            BishopMagics[s] = BISHOP_MAGICS_INIT[s];
-            uint64_t edges = util::Rank1 | util::Rank8 | util::FileA | util::FileH;
-            BishopMagics[s].mask &= ~edges;
-
-            // std::cout << "Bishop Masks for Sq: " << (int)s << '\n';
-            // chess::print_bitboard(BishopMagics[s].mask);
-
-            uint64_t b = util::Empty;
-            int num_blockers = util::count_bits(BishopMagics[s].mask);
-            for (int i = 0; i < (1 << num_blockers); ++i)
-            {
-                int deltas[] = {-9, -7, 7, 9};
-                uint64_t attacks = generate_attacks_on_the_fly(s, b, deltas, 4);
-                size_t magic_index = (b * BishopMagics[s].magic) >> BishopMagics[s].shift;
-                BishopAttacks[s][magic_index] = attacks;
-                b = (b - BishopMagics[s].mask) & BishopMagics[s].mask; // Carry-rippler trick
-            }
+            return slide(s, blockers, 1, 1) | slide(s, blockers, 1, -1) | slide(s, blockers, -1, 1) | slide(s, blockers, -1, -1);
         }
 
-        // Initializes all slider piece attacks (rooks and bishops)
-        void init_magics()
+        // Squares reached by one step of each (rank, file) offset
+        constexpr std::array<uint64_t, SQUARE_NB> make_leaper_attacks(const int (&dr)[8], const int (&df)[8])
         {
-            for (Square s = A1; s <= H8; s = Square(s + 1))
-            {
-                init_rook_magics(s);
-                init_bishop_magics(s);
-            }
+            std::array<uint64_t, SQUARE_NB> attacks{};
+            for (int s = 0; s < 64; ++s)
+                for (int i = 0; i < 8; ++i)
+                    if (on_board(s / 8 + dr[i], s % 8 + df[i]))
+                        attacks[s] |= 1ULL << (s + dr[i] * 8 + df[i]);
+            return attacks;
         }
 
-        // Initializes pawn, knight, and king attack tables
-        void init_leaper_attacks()
+        constexpr std::array<std::array<uint64_t, SQUARE_NB>, COLOR_NB> make_pawn_attacks()
         {
-            for (Square s = A1; s <= H8; s = Square(s + 1))
+            std::array<std::array<uint64_t, SQUARE_NB>, COLOR_NB> attacks{};
+            for (int s = 0; s < 64; ++s)
             {
-                // Pawns
-                uint64_t white_pawn_attacks = util::Empty;
-                uint64_t black_pawn_attacks = util::Empty;
-                if (!util::get_bit(util::FileA, s))
-                { // Not on File A
-                    if (s <= H7)
-                        util::set_bit(white_pawn_attacks, Square(s + 7));
-                    if (s >= A2)
-                        util::set_bit(black_pawn_attacks, Square(s - 9));
-                }
-                if (!util::get_bit(util::FileH, s))
-                { // Not on File H
-                    if (s <= H7)
-                        util::set_bit(white_pawn_attacks, Square(s + 9));
-                    if (s >= A2)
-                        util::set_bit(black_pawn_attacks, Square(s - 7));
+                for (int df = -1; df <= 1; df += 2)
+                {
+                    if (on_board(s / 8 + 1, s % 8 + df))
+                        attacks[WHITE][s] |= 1ULL << (s + 8 + df);
+                    if (on_board(s / 8 - 1, s % 8 + df))
+                        attacks[BLACK][s] |= 1ULL << (s - 8 + df);
                 }
-                PawnAttacks[WHITE][s] = white_pawn_attacks;
-                PawnAttacks[BLACK][s] = black_pawn_attacks;
+            }
+            return attacks;
+        }
 
-                // Knights and Kings
-                int knight_deltas[] = {-17, -15, -10, -6, 6, 10, 15, 17};
-                int king_deltas[] = {-9, -8, -7, -1, 1, 7, 8, 9};
+        constexpr int knight_dr[8] = {-2, -2, -1, -1, 1, 1, 2, 2};
+        constexpr int knight_df[8] = {-1, 1, -2, 2, -2, 2, -1, 1};
+        constexpr int king_dr[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+        constexpr int king_df[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
 
-                for (int delta : knight_deltas)
-                {
-                    Square target = Square(s + delta);
-                    if (target >= A1 && target <= H8 && square_distance(s, target) <= 2)
-                    {
-                        util::set_bit(KnightAttacks[s], target);
-                    }
-                }
-                for (int delta : king_deltas)
+        enum SquarePairTable { BETWEEN, RAY, LINE };
+
+        // For every pair of squares on a common rank, file or diagonal: the squares strictly
+        // between them, the ray from s1 up to and including s2, or the whole line through both.
+        // Unaligned pairs (and s1 == s2) are empty.
+        constexpr std::array<std::array<uint64_t, SQUARE_NB>, SQUARE_NB> make_square_pair_table(SquarePairTable kind)
+        {
+            std::array<std::array<uint64_t, SQUARE_NB>, SQUARE_NB> table{};
+            for (int s1 = 0; s1 < 64; ++s1)
+            {
+                for (int s2 = 0; s2 < 64; ++s2)
                 {
-                    Square target = Square(s + delta);
-                    if (target >= A1 && target <= H8 && square_distance(s, target) <= 1)
-                    {
-                        util::set_bit(KingAttacks[s], target);
-                    }
+                    const int rank_diff = s2 / 8 - s1 / 8;
+                    const int file_diff = s2 % 8 - s1 % 8;
+                    if (s1 == s2 || (rank_diff != 0 && file_diff != 0 && rank_diff != file_diff && rank_diff != -file_diff))
+                        continue;
+
+                    const int dr = (rank_diff > 0) - (rank_diff < 0);
+                    const int df = (file_diff > 0) - (file_diff < 0);
+                    const uint64_t ray = slide(s1, 1ULL << s2, dr, df);
+
+                    if (kind == BETWEEN)
+                        table[s1][s2] = ray & ~(1ULL << s2);
+                    else if (kind == RAY)
+                        table[s1][s2] = ray;
+                    else
+                        table[s1][s2] = slide(s1, 0, dr, df) | slide(s1, 0, -dr, -df) | (1ULL << s1);
                 }
             }
+            return table;
         }
 
-    } // anonymous namespace
+        // Entries a square's slice of the shared attack table needs for the active index scheme
+        constexpr int slice_size(uint64_t mask, uint8_t shift)
+        {
+#if defined(USE_PEXT)
+            (void)shift;
+            return 1 << popcount(mask);
+#else
+            (void)mask;
+            return 1 << (64 - shift);
+#endif
+        }
 
-    uint64_t Between[chess::SQUARE_NB][chess::SQUARE_NB];
-    uint64_t Rays[chess::SQUARE_NB][chess::SQUARE_NB];
+        // Relevant blockers: the attack rays minus the last square of each, which never blocks anything
+        constexpr uint64_t relevant_mask(int s, uint64_t mask, bool rook)
+        {
+            const uint64_t edges = rook ? ((util::Rank1 | util::Rank8) & ~util::Rank[s]) | ((util::FileA | util::FileH) & ~util::File[s])
+                                        : util::Rank1 | util::Rank8 | util::FileA | util::FileH;
+            return mask & ~edges;
+        }
 
-    void generate_between_and_ray_tables() noexcept
-    {
-        // Initialize all tables to 0ULL (empty bitboard)
-        for (int s1 = 0; s1 < 64; ++s1)
+        // Lays the squares' slices out back to back in "table"
+        constexpr std::array<Magic, SQUARE_NB> make_magics(const uint64_t (&masks)[64], const uint64_t (&magics)[64], const uint8_t (&shifts)[64], uint64_t *table, bool rook)
         {
-            for (int s2 = 0; s2 < 64; ++s2)
+            std::array<Magic, SQUARE_NB> result{};
+            int offset = 0;
+            for (int s = 0; s < 64; ++s)
             {
-                Between[s1][s2] = 0ULL;
-                Rays[s1][s2] = 0ULL;
+                result[s] = {relevant_mask(s, masks[s], rook), magics[s], shifts[s], table + offset};
+                offset += slice_size(result[s].mask, shifts[s]);
             }
+            return result;
         }
 
-        for (int s1 = 0; s1 < 64; ++s1)
+        constexpr int table_entries(const uint64_t (&masks)[64], const uint8_t (&shifts)[64], bool rook)
         {
-            for (int s2 = 0; s2 < 64; ++s2)
-            {
-                if (s1 == s2)
-                    continue; // No squares between a square and itself
-
-                // Get original coordinates without swapping
-                int s1_rank = s1 / 8;
-                int s1_file = s1 % 8;
-                int s2_rank = s2 / 8;
-                int s2_file = s2 % 8;
-
-                // Calculate the raw difference to check for alignment
-                int rank_diff = s2_rank - s1_rank;
-                int file_diff = s2_file - s1_file;
-
-                // Check if the squares are aligned on a rank, file, or diagonal
-                // This is a much clearer way to check than the original logic
-                if ((rank_diff != 0 && file_diff != 0) && (std::abs(rank_diff) != std::abs(file_diff)))
-                {
-                    continue; // Not a straight line, so no ray/between squares
-                }
+            int entries = 0;
+            for (int s = 0; s < 64; ++s)
+                entries += slice_size(relevant_mask(s, masks[s], rook), shifts[s]);
+            return entries;
+        }
+
+        static_assert(table_entries(rook_masks, magicmoves_r_shifts, true) <= ROOK_TABLE_SIZE, "RookTable too small");
+        static_assert(table_entries(bishop_masks, magicmoves_b_shifts, false) <= BISHOP_TABLE_SIZE, "BishopTable too small");
 
-                // FIX: Calculate the unit direction vector (the "step")
-                // This will be -1, 0, or 1 for both rank and file
-                int dr = (rank_diff > 0) ? 1 : (rank_diff < 0) ? -1
-                                                               : 0;
-                int df = (file_diff > 0) ? 1 : (file_diff < 0) ? -1
-                                                               : 0;
+    } // anonymous namespace
 
-                uint64_t between_mask = 0ULL;
+    //-----------------------------------------------------------------------------
+    // TABLE DEFINITIONS
+    //
+    // These are the definitions of the tables declared 'extern' in the header file.
+    //-----------------------------------------------------------------------------
 
-                // FIX: Start "crawling" from s1 towards s2 one step at a time
-                int current_rank = s1_rank + dr;
-                int current_file = s1_file + df;
+    constexpr std::array<std::array<uint64_t, SQUARE_NB>, COLOR_NB> PawnAttacks = make_pawn_attacks();
+    constexpr std::array<uint64_t, SQUARE_NB> KnightAttacks = make_leaper_attacks(knight_dr, knight_df);
+    constexpr std::array<uint64_t, SQUARE_NB> KingAttacks = make_leaper_attacks(king_dr, king_df);
 
-                while (current_rank != s2_rank || current_file != s2_file)
-                {
-                    int current_square = current_rank * 8 + current_file;
-                    between_mask |= (1ULL << current_square);
-                    current_rank += dr;
-                    current_file += df;
-                }
+    constexpr std::array<std::array<uint64_t, SQUARE_NB>, SQUARE_NB> Between = make_square_pair_table(BETWEEN);
+    constexpr std::array<std::array<uint64_t, SQUARE_NB>, SQUARE_NB> Rays = make_square_pair_table(RAY);
+    constexpr std::array<std::array<uint64_t, SQUARE_NB>, SQUARE_NB> Line = make_square_pair_table(LINE);
 
-                // The squares BETWEEN s1 and s2
-                Between[s1][s2] = between_mask;
+    uint64_t RookTable[ROOK_TABLE_SIZE];
+    uint64_t BishopTable[BISHOP_TABLE_SIZE];
+    constexpr std::array<Magic, SQUARE_NB> RookMagics = make_magics(rook_masks, magicmoves_r_magics, magicmoves_r_shifts, RookTable, true);
+    constexpr std::array<Magic, SQUARE_NB> BishopMagics = make_magics(bishop_masks, magicmoves_b_magics, magicmoves_b_shifts, BishopTable, false);
 
-                // The RAY includes the squares between AND the destination square s2
-                Rays[s1][s2] = between_mask | (1ULL << s2);
+    namespace
+    {
+        // Fills every square's slice by enumerating all blocker subsets of its mask
+        template <typename AttacksFn>
+        bool init_slider_attacks(const std::array<Magic, SQUARE_NB> &magics, AttacksFn attacks_on_the_fly)
+        {
+            for (int s = 0; s < 64; ++s)
+            {
+                const Magic &m = magics[s];
+                uint64_t b = util::Empty;
+                do
+                {
+                    m.attacks[m.index(b)] = attacks_on_the_fly(s, b);
+                    b = (b - m.mask) & m.mask; // Carry-rippler trick
+                } while (b);
             }
+            return true;
         }
-    }
 
-    //-----------------------------------------------------------------------------
-    // MAIN INITIALIZATION FUNCTION
-    //-----------------------------------------------------------------------------
-    void init()
-    {
-        init_leaper_attacks();
-        init_magics();
-        generate_between_and_ray_tables();
-    }
+        // Runs during static initialization, so the tables are ready before main()
+        const bool slider_attacks_ready = init_slider_attacks(RookMagics, rook_attacks_on_the_fly) &&
+                                          init_slider_attacks(BishopMagics, bishop_attacks_on_the_fly);
+    } // anonymous namespace
 };
-// namespace chess
\ No newline at end of file
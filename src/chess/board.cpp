@@ -1,6 +1,7 @@
 #include "chess/board.h"
 #include "chess/bitboard.h"
 #include "chess/zobrist.h"
+#include <cassert>
 #include <cstring>
 #include <sstream>
 #include <stdexcept>
@@ -12,6 +13,9 @@ Board::Board() {
     clear();
 }
 
+// A copy of another board's position without its moves; those are reached through history
+Board::Board(const Position& pos, const GameHistory* history) : Position(pos), history(history) {}
+
 // ----------------- Clear board -----------------
 void Board::clear() {
     std::memset(bitboard, 0, sizeof(bitboard));
@@ -21,15 +25,19 @@ void Board::clear() {
     en_passant_sq = chess::SQUARE_NONE;
     halfmove_clock = 0;
     fullmove_number = 1;
-    pinned = 0ULL;
+    pinned = PINS_UNKNOWN;
     checks = 0ULL;
-    check_mask = 0ULL;
     double_check = false;
     white_king_sq = black_king_sq = chess::SQUARE_NONE;
     zobrist_key = zobrist_pawn_key = 0;
-    material_white = material_black = 0;
+    psq = 0;
+    non_pawn_material[chess::WHITE] = non_pawn_material[chess::BLACK] = 0;
+    game_phase = 0;
     white_occupied = black_occupied = occupied = 0;
+    threats_known = 0;
+    check_info_known = false;
     undo_stack.clear();
+    history = nullptr;
 }
 
 // ----------------- FEN parsing -----------------
@@ -91,11 +99,54 @@ void Board::set_fen(std::string &fen_cstr) {
     fullmove_number = fullmove;
     update_king_squares_from_bitboards();
     update_occupancies();
-    update_game_phase();
-    compute_pins_and_checks();
+    refresh_accumulators();
+    compute_checks();
+    pinned = PINS_UNKNOWN;
+    threats_known = 0;
+    check_info_known = false;
     zobrist_key = Zobrist::calculate_zobrist_hash(*this);
 }
 
+void Board::refresh_accumulators() {
+    psq = 0;
+    non_pawn_material[chess::WHITE] = non_pawn_material[chess::BLACK] = 0;
+    game_phase = 0;
+    for (int sq = chess::A1; sq <= chess::H8; ++sq) {
+        if (board_array[sq] != chess::NO_PIECE) add_to_accumulators(board_array[sq], (chess::Square)sq);
+    }
+}
+
+bool Board::occupancies_consistent() const {
+    uint64_t white = 0, black = 0;
+    for (int p = chess::WP; p <= chess::WK; ++p) white |= bitboard[p];
+    for (int p = chess::BP; p <= chess::BK; ++p) black |= bitboard[p];
+    return white == white_occupied && black == black_occupied && (white | black) == occupied;
+}
+
+// ----------------- History -----------------
+GameHistory Board::game_history() const {
+    GameHistory keys;
+    if (history) keys = *history;
+    for (size_t i = 0; i < undo_stack.size(); ++i) keys.push_back(undo_stack[i].zobrist_before);
+    return keys;
+}
+
+bool Board::is_repetition_draw() const {
+    // The position can only repeat if there were no pawn pushes or captures.
+    // The halfmove clock records that number of moves, so only that many entries are searched.
+    int window = halfmove_clock;
+    int rep_count = 0;
+    for (int i = (int)undo_stack.size() - 1; i >= 0 && window > 0; --i, --window) {
+        if (undo_stack[i].zobrist_before == zobrist_key && ++rep_count >= 2) return true;
+    }
+    if (history) {
+        for (auto it = history->rbegin(); it != history->rend() && window > 0; ++it, --window) {
+            if (*it == zobrist_key && ++rep_count >= 2) return true; // 2 times already and this is the third time
+        }
+    }
+    return false;
+}
+
 // ----------------- FEN serialization -----------------
 std::string Board::to_fen() const {
     std::string fen;
@@ -208,7 +259,8 @@ void Board::print_board() const {
     std::cout << "Fullmove number: " << fullmove_number << "\n";
     std::cout << "Zobrist key: 0x" << std::hex << zobrist_key << std::dec << "\n";
     std::cout << "Game Phase: " << game_phase << "\n";
-    std::cout << "Material (W/B): " << material_white << " / " << material_black << "\n\n";
+    std::cout << "Non-pawn material (W/B): " << non_pawn_material[chess::WHITE] << " / " << non_pawn_material[chess::BLACK] << "\n";
+    std::cout << "PSQ (mg/eg): " << psqt::mg_value(psq) << " / " << psqt::eg_value(psq) << "\n\n";
 }
 
 //-----------------------------------------------------------------------------
@@ -220,12 +272,10 @@ void Board::make_move(const chess::Move &mv) {
     undo.prev_castle_rights = castle_rights;
     undo.prev_en_passant_sq = en_passant_sq;
     undo.captured_piece_and_halfmove = (halfmove_clock << 4) | chess::NO_PIECE;
-    undo.check_mask = check_mask;
     undo.checks  = checks;
     undo.pinned = pinned;
-    undo.double_check = double_check;
     undo.zobrist_before = zobrist_key;
-    undo.game_phase = game_phase;
+    undo.psq = psq;
 
     // 2. Extract move details
     const chess::Square from = (chess::Square)mv.from();
@@ -234,20 +284,10 @@ void Board::make_move(const chess::Move &mv) {
     
     const chess::Piece moving_piece = (chess::Piece)board_array[from];  //remove the moved piece
 
-    zobrist_key ^= Zobrist::piecesArray[moving_piece][from];
-
     chess::Piece captured_piece = (flags & chess::FLAG_EP) 
         ? (white_to_move ? chess::BP : chess::WP)
         : (chess::Piece)board_array[to];
 
-    if(captured_piece != chess::NO_PIECE){ 
-        if(flags & chess::FLAG_EP){
-            zobrist_key ^= Zobrist::piecesArray[captured_piece][white_to_move ? to - 8 : to + 8];  //remove captured piece
-        }
-        else zobrist_key ^= Zobrist::piecesArray[captured_piece][to];  //remove captured piece
-    }
-    zobrist_key ^= Zobrist::piecesArray[moving_piece][to];  //add the moved piece
-
     // Reset halfmove clock if it's a pawn move or capture
     if (chess::type_of(moving_piece) == chess::PAWN || captured_piece != chess::NO_PIECE) {
         halfmove_clock = 0;
@@ -266,32 +306,35 @@ void Board::make_move(const chess::Move &mv) {
     // 3. Handle move types
     if (flags == chess::FLAG_QUIET) {
         move_piece_bb(moving_piece, from, to);
+        psq += psqt::table[moving_piece][to] - psqt::table[moving_piece][from];
     } 
     else if (flags == chess::FLAG_CAPTURE) {
-        util::pop_bit(bitboard[captured_piece], to);
+        remove_piece(captured_piece, to);
         move_piece_bb(moving_piece, from, to);
+        remove_from_accumulators(captured_piece, to);
+        psq += psqt::table[moving_piece][to] - psqt::table[moving_piece][from];
     }
     else if (flags & chess::FLAG_PROMO) {
         const chess::Piece promo_piece = (chess::Piece)mv.promo();
         // Remove the pawn
-        util::pop_bit(bitboard[moving_piece], from);
-        board_array[from] = chess::NO_PIECE;
+        remove_piece(moving_piece, from);
         // If it was a capture, remove the captured piece
         if (flags & chess::FLAG_CAPTURE) {
-            util::pop_bit(bitboard[captured_piece], to);
+            remove_piece(captured_piece, to);
         }
         // Place the new piece
-        util::set_bit(bitboard[promo_piece], to);
-        board_array[to] = promo_piece;
+        put_piece(promo_piece, to);
 
-        zobrist_key ^= Zobrist::piecesArray[moving_piece][to]; //since the pawn is no longer at the destination square
-        zobrist_key ^= Zobrist::piecesArray[promo_piece][to];
+        if (flags & chess::FLAG_CAPTURE) remove_from_accumulators(captured_piece, to);
+        remove_from_accumulators(moving_piece, from);
+        add_to_accumulators(promo_piece, to);
     }
     else if (flags == chess::FLAG_EP) {
         move_piece_bb(moving_piece, from, to);
         const chess::Square captured_pawn_sq = white_to_move ? (chess::Square)(to - 8) : (chess::Square)(to + 8);
-        util::pop_bit(bitboard[captured_piece], captured_pawn_sq);
-        board_array[captured_pawn_sq] = chess::NO_PIECE;
+        remove_piece(captured_piece, captured_pawn_sq);
+        remove_from_accumulators(captured_piece, captured_pawn_sq);
+        psq += psqt::table[moving_piece][to] - psqt::table[moving_piece][from];
     }
     else if (flags == chess::FLAG_CASTLE) {
         move_piece_bb(moving_piece, from, to); // Move king
@@ -300,14 +343,15 @@ void Board::make_move(const chess::Move &mv) {
         else if (to == chess::C1) { rook_from = chess::A1; rook_to = chess::D1; }
         else if (to == chess::G8) { rook_from = chess::H8; rook_to = chess::F8; }
         else /* (to == C8) */ { rook_from = chess::A8; rook_to = chess::D8; }
-        move_piece_bb((chess::Piece)board_array[rook_from], rook_from, rook_to);
-
-        zobrist_key ^= Zobrist::piecesArray[chess::make_piece(white_to_move ? chess::WHITE : chess::BLACK,chess::ROOK)][rook_from];
-        zobrist_key ^= Zobrist::piecesArray[chess::make_piece(white_to_move ? chess::WHITE : chess::BLACK,chess::ROOK)][rook_to];
+        const chess::Piece rook = (chess::Piece)board_array[rook_from];
+        move_piece_bb(rook, rook_from, rook_to);
+        psq += psqt::table[moving_piece][to] - psqt::table[moving_piece][from];
+        psq += psqt::table[rook][rook_to] - psqt::table[rook][rook_from];
     }
     // Handle pawn double push to set en passant square
     else if (flags == chess::FLAG_DOUBLE_PUSH) {
         move_piece_bb(moving_piece, from, to);
+        psq += psqt::table[moving_piece][to] - psqt::table[moving_piece][from];
         en_passant_sq = white_to_move ? (chess::Square)(from + 8) : (chess::Square)(from - 8);
     }
 
@@ -331,17 +375,6 @@ void Board::make_move(const chess::Move &mv) {
         castle_rights &= chess::CastlingRights(~chess::BLACK_KINGSIDE);
     }
 
-    zobrist_key ^= Zobrist::castlingRights[undo.prev_castle_rights];
-    zobrist_key ^= Zobrist::castlingRights[castle_rights];
-    
-    if(undo.prev_en_passant_sq != chess::SQUARE_NONE)
-    {
-       zobrist_key ^= Zobrist::enPassantFile[undo.prev_en_passant_sq];
-    }
-    if (en_passant_sq != chess::SQUARE_NONE) {
-        zobrist_key ^= Zobrist::enPassantFile[en_passant_sq];
-    }
-    
     // 5. Update king square if it moved
     if (moving_piece == chess::WK) white_king_sq = to;
     if (moving_piece == chess::BK) black_king_sq = to;
@@ -350,12 +383,13 @@ void Board::make_move(const chess::Move &mv) {
     if (!white_to_move) fullmove_number++;
     white_to_move = !white_to_move;
 
-    zobrist_key ^= Zobrist::sideToMove; //Always flip this
-
-    // 7. Update combined bitboards
-    update_occupancies();
-    update_game_phase();
-    compute_pins_and_checks();
+    // 7. Occupancies were updated along with the pieces
+    assert(occupancies_consistent());
+    compute_checks();
+    pinned = PINS_UNKNOWN;
+    threats_known = 0;
+    check_info_known = false;
+    // Hashed from scratch: Zobrist::piecesArray is laid out in Polyglot order, not by chess::Piece
     zobrist_key = Zobrist::calculate_zobrist_hash(*this);
 
     // 8. Push state to undo stack
@@ -368,7 +402,7 @@ void Board::make_move(const chess::Move &mv) {
 //-----------------------------------------------------------------------------
 void Board::unmake_move(const chess::Move &mv) {
     // 1. Pop the last state from the undo stack
-    chess::Undo undo = undo_stack.back();
+    const chess::Undo undo = undo_stack.back();
     undo_stack.pop_back();
 
     // 2. Extract move details
@@ -380,12 +414,11 @@ void Board::unmake_move(const chess::Move &mv) {
     castle_rights = (chess::CastlingRights)undo.prev_castle_rights;
     en_passant_sq = (chess::Square)undo.prev_en_passant_sq;
     halfmove_clock = undo.captured_piece_and_halfmove >> 4;
-    check_mask = undo.check_mask;
     checks  = undo.checks;
     pinned = undo.pinned;
-    double_check = undo.double_check;
+    double_check = checks & (checks - 1);
     zobrist_key = undo.zobrist_before;
-    game_phase = undo.game_phase;
+    psq = undo.psq;
 
     // Switch side back
     white_to_move = !white_to_move;
@@ -400,17 +433,17 @@ void Board::unmake_move(const chess::Move &mv) {
         const chess::Piece promo_piece = (chess::Piece)mv.promo();
         
         // Remove promoted piece
-        util::pop_bit(bitboard[promo_piece], to);
+        remove_piece(promo_piece, to);
         // Place pawn back
-        util::set_bit(bitboard[moving_piece], from);
-        board_array[from] = moving_piece;
-        board_array[to] = chess::NO_PIECE; // Clear the to square first
+        put_piece(moving_piece, from);
         
         // If it was a capture, restore the captured piece
         if (flags & chess::FLAG_CAPTURE) {
-            util::set_bit(bitboard[captured_piece], to);
-            board_array[to] = captured_piece;
+            put_piece(captured_piece, to);
+            add_material(captured_piece);
         }
+        remove_material(promo_piece);
+        add_material(moving_piece);
     }
     else if (flags == chess::FLAG_QUIET || flags == chess::FLAG_DOUBLE_PUSH) {
         restore_piece_bb(moving_piece, from, to);
@@ -418,15 +451,15 @@ void Board::unmake_move(const chess::Move &mv) {
     else if (flags == chess::FLAG_CAPTURE) {
         restore_piece_bb(moving_piece, from, to);
         // Restore the captured piece
-        util::set_bit(bitboard[captured_piece], to);
-        board_array[to] = captured_piece;
+        put_piece(captured_piece, to);
+        add_material(captured_piece);
     }
     else if (flags == chess::FLAG_EP) {
         restore_piece_bb(moving_piece, from, to);
         const chess::Square captured_pawn_sq = white_to_move ? (chess::Square)(to - 8) : (chess::Square)(to + 8);
         // Restore captured pawn
-        util::set_bit(bitboard[captured_piece], captured_pawn_sq);
-        board_array[captured_pawn_sq] = captured_piece;
+        put_piece(captured_piece, captured_pawn_sq);
+        add_material(captured_piece);
     }
     else if (flags == chess::FLAG_CASTLE) {
         restore_piece_bb(moving_piece, from, to); // Move king back
@@ -443,8 +476,52 @@ void Board::unmake_move(const chess::Move &mv) {
     if (moving_piece == chess::WK) white_king_sq = from;
     if (moving_piece == chess::BK) black_king_sq = from;
 
-    // 5. Update combined bitboards
-    update_occupancies();
+    // 5. Occupancies were restored along with the pieces; attack maps are rebuilt on demand
+    assert(occupancies_consistent());
+    threats_known = 0;
+    check_info_known = false;
+}
+
+//-----------------------------------------------------------------------------
+// NULL MOVE
+//-----------------------------------------------------------------------------
+// Only the side, the en passant square and the hash change. Checks are left alone: we were
+// not in check, so the opponent is not either. Pins belong to the side to move and are
+// looked up again on demand.
+void Board::make_null_move() {
+    chess::Undo undo;
+    undo.zobrist_before = zobrist_key;
+    undo.prev_en_passant_sq = en_passant_sq;
+    undo.captured_piece_and_halfmove = (halfmove_clock << 4) | chess::NO_PIECE;
+    undo.pinned = pinned;
+    undo.checks = checks;
+
+    // The file is only part of the hash if a pawn of the side to move could capture
+    zobrist_key ^= Zobrist::en_passant_key(*this);
+    en_passant_sq = chess::SQUARE_NONE;
+
+    halfmove_clock++;
+    white_to_move = !white_to_move;
+    zobrist_key ^= Zobrist::sideToMove;
+
+    // The side that moves now has its own pins and checks to give, found when asked for
+    pinned = PINS_UNKNOWN;
+    check_info_known = false;
+
+    undo_stack.push_back(undo);
+}
+
+void Board::unmake_null_move() {
+    const chess::Undo& undo = undo_stack.back();
+    zobrist_key = undo.zobrist_before;
+    en_passant_sq = (chess::Square)undo.prev_en_passant_sq;
+    halfmove_clock = undo.captured_piece_and_halfmove >> 4;
+    pinned = undo.pinned;
+    checks = undo.checks;
+    double_check = checks & (checks - 1);
+    white_to_move = !white_to_move;
+    check_info_known = false;
+    undo_stack.pop_back();
 }
 
 bool Board::square_attacked(chess::Square sq, bool by_white) const{
@@ -497,6 +574,113 @@ uint64_t Board::attackers_to(chess::Square sq, bool by_white) const {
     return attackers_bitboard;
 }
 
+uint64_t Board::attackers_to(chess::Square sq, uint64_t occupancy) const {
+    const uint64_t orthogonal_pieces = bitboard[chess::WR] | bitboard[chess::BR] | bitboard[chess::WQ] | bitboard[chess::BQ];
+    const uint64_t diagonal_pieces   = bitboard[chess::WB] | bitboard[chess::BB] | bitboard[chess::WQ] | bitboard[chess::BQ];
+
+    return (chess::PawnAttacks[chess::BLACK][sq] & bitboard[chess::WP])
+         | (chess::PawnAttacks[chess::WHITE][sq] & bitboard[chess::BP])
+         | (chess::KnightAttacks[sq] & (bitboard[chess::WN] | bitboard[chess::BN]))
+         | (chess::KingAttacks[sq] & (bitboard[chess::WK] | bitboard[chess::BK]))
+         | (chess::get_orthogonal_slider_attacks(sq, occupancy) & orthogonal_pieces)
+         | (chess::get_diagonal_slider_attacks(sq, occupancy) & diagonal_pieces);
+}
+
+bool Board::king_move_safe(chess::Square to) const {
+    const uint64_t king_bb = bitboard[white_to_move ? chess::WK : chess::BK];
+    const uint64_t theirs = white_to_move ? black_occupied : white_occupied;
+
+    // Without the king on the board a slider checking along the ray still covers the square behind it
+    return !(attackers_to(to, occupied ^ king_bb) & theirs);
+}
+
+// En passant removes two pawns from the same rank, so a pin on the capturing pawn alone does not
+// tell the whole story (e.g. king and rook on the 5th rank with both pawns in between).
+// Check the resulting position directly.
+bool Board::ep_capture_legal(chess::Square from) const {
+    const chess::Square king_sq = white_to_move ? white_king_sq : black_king_sq;
+    const chess::Square captured_sq = (chess::Square)(en_passant_sq + (white_to_move ? -8 : 8));
+    const uint64_t captured_bb = ONE << captured_sq;
+    const uint64_t occupancy = (occupied ^ (ONE << from) ^ captured_bb) | (ONE << en_passant_sq);
+    const uint64_t theirs = (white_to_move ? black_occupied : white_occupied) & ~captured_bb;
+
+    return !(attackers_to(king_sq, occupancy) & theirs);
+}
+
+// Swap-off on the target square: both sides keep recapturing with their least valuable attacker,
+// and either may stop when continuing would lose material. Pins are ignored.
+bool Board::see_ge(const chess::Move& mv, int threshold) const {
+    // Castling and promotions are not exchanges
+    if (mv.flags() & (chess::FLAG_CASTLE | chess::FLAG_PROMO)) return 0 >= threshold;
+
+    const chess::Square from = (chess::Square)mv.from();
+    const chess::Square to = (chess::Square)mv.to();
+    const bool is_ep = mv.flags() & chess::FLAG_EP;
+
+    // What we win if the capture is not answered, minus what we must win
+    int swap = util::see_values[is_ep ? chess::PAWN : chess::type_of(board_array[to])] - threshold;
+    if (swap < 0) return false;
+
+    // ... and if it is answered by taking our piece
+    swap = util::see_values[chess::type_of(board_array[from])] - swap;
+    if (swap <= 0) return true;
+
+    uint64_t occupancy = occupied ^ (ONE << from) ^ (ONE << to);
+    if (is_ep) occupancy ^= ONE << (white_to_move ? to - 8 : to + 8);
+
+    const uint64_t diagonal_pieces   = bitboard[chess::WB] | bitboard[chess::BB] | bitboard[chess::WQ] | bitboard[chess::BQ];
+    const uint64_t orthogonal_pieces = bitboard[chess::WR] | bitboard[chess::BR] | bitboard[chess::WQ] | bitboard[chess::BQ];
+
+    uint64_t attackers = attackers_to(to, occupancy);
+    bool stm_white = white_to_move;
+    int res = 1;
+
+    while (true) {
+        stm_white = !stm_white;
+        attackers &= occupancy;
+
+        const chess::Color stm = stm_white ? chess::WHITE : chess::BLACK;
+        const uint64_t stm_attackers = attackers & (stm_white ? white_occupied : black_occupied);
+        if (!stm_attackers) break;
+
+        res ^= 1;
+
+        // Capture with the least valuable attacker. Removing it may uncover a slider behind it.
+        uint64_t bb;
+        if ((bb = stm_attackers & bitboard[chess::make_piece(stm, chess::PAWN)])) {
+            if ((swap = util::see_values[chess::PAWN] - swap) < res) break;
+            occupancy ^= ONE << util::lsb(bb);
+            attackers |= chess::get_diagonal_slider_attacks(to, occupancy) & diagonal_pieces;
+        }
+        else if ((bb = stm_attackers & bitboard[chess::make_piece(stm, chess::KNIGHT)])) {
+            if ((swap = util::see_values[chess::KNIGHT] - swap) < res) break;
+            occupancy ^= ONE << util::lsb(bb);
+        }
+        else if ((bb = stm_attackers & bitboard[chess::make_piece(stm, chess::BISHOP)])) {
+            if ((swap = util::see_values[chess::BISHOP] - swap) < res) break;
+            occupancy ^= ONE << util::lsb(bb);
+            attackers |= chess::get_diagonal_slider_attacks(to, occupancy) & diagonal_pieces;
+        }
+        else if ((bb = stm_attackers & bitboard[chess::make_piece(stm, chess::ROOK)])) {
+            if ((swap = util::see_values[chess::ROOK] - swap) < res) break;
+            occupancy ^= ONE << util::lsb(bb);
+            attackers |= chess::get_orthogonal_slider_attacks(to, occupancy) & orthogonal_pieces;
+        }
+        else if ((bb = stm_attackers & bitboard[chess::make_piece(stm, chess::QUEEN)])) {
+            if ((swap = util::see_values[chess::QUEEN] - swap) < res) break;
+            occupancy ^= ONE << util::lsb(bb);
+            attackers |= (chess::get_diagonal_slider_attacks(to, occupancy) & diagonal_pieces)
+                       | (chess::get_orthogonal_slider_attacks(to, occupancy) & orthogonal_pieces);
+        }
+        else {
+            // King: the capture only stands if the other side has nothing left to recapture with
+            return (attackers & (stm_white ? black_occupied : white_occupied)) ? res ^ 1 : res;
+        }
+    }
+
+    return res;
+}
+
 bool Board::is_position_legal()
 {
       chess::Square king_sq = white_to_move
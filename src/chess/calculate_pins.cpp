@@ -1,68 +1,136 @@
 #include "chess/board.h" // Assuming this contains your class and necessary definitions
 
 /**
- * @brief A highly optimized function to calculate all pins, checks, and check masks.
- * * This function consolidates the logic for orthogonal, diagonal, and knight/pawn checks
- * to minimize overhead and redundant calculations.
+ * @brief Finds the pieces giving check to the side to move.
+ * * Runs after every move, so it is kept to one lookup per attacker kind. The check mask
+ * and double check follow from the result; pins are left to compute_pins().
  */
-void Board::compute_pins_and_checks() {
-    pinned = 0ULL;
-    checks = 0ULL;
-    check_mask = 0ULL;
-    double_check = false;
-
+void Board::compute_checks() {
     const chess::Color color = white_to_move ? chess::WHITE : chess::BLACK;
     const chess::Color oppColor = white_to_move ? chess::BLACK : chess::WHITE;
     const chess::Square king_sq = white_to_move ? white_king_sq : black_king_sq;
-    const uint64_t friendly_bitboard = white_to_move ? white_occupied : black_occupied;
 
-    const uint64_t opp_rooks_queens = bitboard[chess::make_piece(oppColor, chess::ROOK)] | 
-                                    bitboard[chess::make_piece(oppColor, chess::QUEEN)];
-    const uint64_t opp_bishops_queens = bitboard[chess::make_piece(oppColor, chess::BISHOP)] | 
-                                      bitboard[chess::make_piece(oppColor, chess::QUEEN)];
-
-    uint64_t ortho_attackers = opp_rooks_queens & chess::get_orthogonal_slider_attacks(king_sq, 0);
-    while (ortho_attackers) {
-        const chess::Square attacker_sq = util::pop_lsb(ortho_attackers);
-        const uint64_t line_between = chess::Between[king_sq][attacker_sq];
-        const uint64_t pieces_on_line = line_between & occupied;
-
-        const int blocker_count = util::count_bits(pieces_on_line);
-
-        if (blocker_count == 0) { 
-            checks |= (1ULL << attacker_sq);
-            check_mask |= chess::Rays[king_sq][attacker_sq];
-        } else if (blocker_count == 1) { 
-            if (pieces_on_line & friendly_bitboard) { 
-                pinned |= pieces_on_line;
-            }
-        }
+    const uint64_t opp_queens = bitboard[chess::make_piece(oppColor, chess::QUEEN)];
+    const uint64_t opp_rooks_queens = bitboard[chess::make_piece(oppColor, chess::ROOK)] | opp_queens;
+    const uint64_t opp_bishops_queens = bitboard[chess::make_piece(oppColor, chess::BISHOP)] | opp_queens;
+
+    checks = (opp_rooks_queens & chess::get_orthogonal_slider_attacks(king_sq, occupied))
+           | (opp_bishops_queens & chess::get_diagonal_slider_attacks(king_sq, occupied))
+           | (chess::KnightAttacks[king_sq] & bitboard[chess::make_piece(oppColor, chess::KNIGHT)])
+           | (chess::PawnAttacks[color][king_sq] & bitboard[chess::make_piece(oppColor, chess::PAWN)]);
+
+    double_check = checks & (checks - 1);
+}
+
+// Pieces of either colour that stand alone between king_sq and one of the snipers
+static uint64_t single_blockers(chess::Square king_sq, uint64_t snipers, uint64_t occupied) {
+    uint64_t blockers = 0ULL;
+    while (snipers) {
+        const chess::Square attacker_sq = util::pop_lsb(snipers);
+        const uint64_t pieces_on_line = chess::Between[king_sq][attacker_sq] & occupied;
+        if (pieces_on_line && !(pieces_on_line & (pieces_on_line - 1))) blockers |= pieces_on_line;
     }
+    return blockers;
+}
 
-    uint64_t diag_attackers = opp_bishops_queens & chess::get_diagonal_slider_attacks(king_sq, 0);
-    while (diag_attackers) {
-        const chess::Square attacker_sq = util::pop_lsb(diag_attackers);
-        const uint64_t line_between = chess::Between[king_sq][attacker_sq];
-        const uint64_t pieces_on_line = line_between & occupied;
-
-        const int blocker_count = util::count_bits(pieces_on_line);
-
-        if (blocker_count == 0) { 
-            checks |= (1ULL << attacker_sq);
-            check_mask |= chess::Rays[king_sq][attacker_sq];
-        } else if (blocker_count == 1) { 
-            if (pieces_on_line & friendly_bitboard) {
-                pinned |= pieces_on_line;
-            }
+/**
+ * @brief Finds the friendly pieces pinned to the king of the side to move.
+ * * Called through pinned_pieces() the first time a position needs it, so nodes that
+ * never generate moves never pay for it.
+ */
+void Board::compute_pins() const {
+    const chess::Color oppColor = white_to_move ? chess::BLACK : chess::WHITE;
+    const chess::Square king_sq = white_to_move ? white_king_sq : black_king_sq;
+    const uint64_t friendly_bitboard = white_to_move ? white_occupied : black_occupied;
+
+    const uint64_t opp_queens = bitboard[chess::make_piece(oppColor, chess::QUEEN)];
+    const uint64_t snipers = ((bitboard[chess::make_piece(oppColor, chess::ROOK)] | opp_queens) & chess::get_orthogonal_slider_attacks(king_sq, 0))
+                           | ((bitboard[chess::make_piece(oppColor, chess::BISHOP)] | opp_queens) & chess::get_diagonal_slider_attacks(king_sq, 0));
+
+    // Exactly one blocker, and it is ours
+    pinned = single_blockers(king_sq, snipers, occupied) & friendly_bitboard;
+}
+
+/**
+ * @brief Finds where each piece type of the side to move would check the enemy king, and
+ * which of our pieces would uncover a check by moving.
+ * * The mirror image of compute_pins(): the same sniper scan, from the enemy king and with
+ * our sliders. Filled on first use, like the pins.
+ */
+void Board::compute_check_info() const {
+    const chess::Color color = white_to_move ? chess::WHITE : chess::BLACK;
+    const chess::Color oppColor = white_to_move ? chess::BLACK : chess::WHITE;
+    const chess::Square their_king = white_to_move ? black_king_sq : white_king_sq;
+    const uint64_t friendly_bitboard = white_to_move ? white_occupied : black_occupied;
+
+    const uint64_t diagonal = chess::get_diagonal_slider_attacks(their_king, occupied);
+    const uint64_t orthogonal = chess::get_orthogonal_slider_attacks(their_king, occupied);
+    check_sq[chess::NO_PIECE_TYPE] = 0ULL;
+    check_sq[chess::PAWN] = chess::PawnAttacks[oppColor][their_king];
+    check_sq[chess::KNIGHT] = chess::KnightAttacks[their_king];
+    check_sq[chess::BISHOP] = diagonal;
+    check_sq[chess::ROOK] = orthogonal;
+    check_sq[chess::QUEEN] = diagonal | orthogonal;
+    check_sq[chess::KING] = 0ULL;
+
+    const uint64_t queens = bitboard[chess::make_piece(color, chess::QUEEN)];
+    const uint64_t snipers = ((bitboard[chess::make_piece(color, chess::ROOK)] | queens) & chess::get_orthogonal_slider_attacks(their_king, 0))
+                           | ((bitboard[chess::make_piece(color, chess::BISHOP)] | queens) & chess::get_diagonal_slider_attacks(their_king, 0));
+    discoverers = single_blockers(their_king, snipers, occupied) & friendly_bitboard;
+
+    check_info_known = true;
+}
+
+/**
+ * @brief Tells whether a legal move of the side to move checks the enemy king, without
+ * making it.
+ * * Direct and discovered checks come from the cached check info. Only promotions, en
+ * passant and castling look at the board as it will be after the move.
+ */
+bool Board::gives_check(const chess::Move& mv) const {
+    const chess::Color color = white_to_move ? chess::WHITE : chess::BLACK;
+    const chess::Square their_king = white_to_move ? black_king_sq : white_king_sq;
+    const chess::Square from = (chess::Square)mv.from();
+    const chess::Square to = (chess::Square)mv.to();
+    const uint64_t from_bb = util::create_bitboard_from_square(from);
+    const uint64_t to_bb = util::create_bitboard_from_square(to);
+    const uint64_t their_king_bb = util::create_bitboard_from_square(their_king);
+    const uint16_t flags = mv.flags();
+
+    // Direct check by the piece that lands on "to"
+    if (flags & chess::FLAG_PROMO) {
+        // The promoted piece looks through the square the pawn left
+        const uint64_t occupancy = occupied ^ from_bb;
+        switch (chess::type_of((chess::Piece)mv.promo())) {
+            case chess::KNIGHT: if (chess::KnightAttacks[to] & their_king_bb) return true; break;
+            case chess::BISHOP: if (chess::get_diagonal_slider_attacks(to, occupancy) & their_king_bb) return true; break;
+            case chess::ROOK:   if (chess::get_orthogonal_slider_attacks(to, occupancy) & their_king_bb) return true; break;
+            default:            if ((chess::get_diagonal_slider_attacks(to, occupancy) | chess::get_orthogonal_slider_attacks(to, occupancy)) & their_king_bb) return true; break;
         }
     }
+    else if (check_squares(chess::type_of(board_array[from])) & to_bb) return true;
 
-    checks |= chess::KnightAttacks[king_sq] & bitboard[chess::make_piece(oppColor, chess::KNIGHT)];
-    checks |= chess::PawnAttacks[color][king_sq] & bitboard[chess::make_piece(oppColor, chess::PAWN)];
+    // Discovered check: the piece leaves the line between one of our sliders and their king
+    if ((discovered_check_candidates() & from_bb) && !(chess::Line[their_king][from] & to_bb)) return true;
 
-    check_mask |= checks;
+    if (flags & chess::FLAG_EP) {
+        // Removing the captured pawn can open a line the pawn itself was not on
+        const chess::Square captured_sq = (chess::Square)(white_to_move ? to - 8 : to + 8);
+        const uint64_t occupancy = (occupied ^ from_bb ^ util::create_bitboard_from_square(captured_sq)) | to_bb;
+        const uint64_t queens = bitboard[chess::make_piece(color, chess::QUEEN)];
+        return (chess::get_orthogonal_slider_attacks(their_king, occupancy) & (bitboard[chess::make_piece(color, chess::ROOK)] | queens))
+             | (chess::get_diagonal_slider_attacks(their_king, occupancy) & (bitboard[chess::make_piece(color, chess::BISHOP)] | queens));
+    }
 
-    if (util::count_bits(checks) > 1) {
-        double_check = true;
+    if (flags & chess::FLAG_CASTLE) {
+        // Only the rook can give check, from next to the king's old square
+        const bool kingside = to > from;
+        const chess::Square rook_from = (chess::Square)(kingside ? from + 3 : from - 4);
+        const chess::Square rook_to = (chess::Square)(kingside ? from + 1 : from - 1);
+        const uint64_t occupancy = (occupied ^ from_bb ^ util::create_bitboard_from_square(rook_from))
+                                 | to_bb | util::create_bitboard_from_square(rook_to);
+        return chess::get_orthogonal_slider_attacks(rook_to, occupancy) & their_king_bb;
     }
-}
\ No newline at end of file
+
+    return false;
+}
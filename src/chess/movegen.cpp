@@ -1,14 +1,76 @@
 #include "chess/movegen.h"
+#include <algorithm>
 
-void MoveGen::init(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly){
+template<chess::Color Us, MoveGen::GenType T>
+void MoveGen::generate(const Board& B, chess::MoveList& moveList){
+    const uint64_t ours = (Us == chess::WHITE) ? B.white_occupied : B.black_occupied;
+    const uint64_t theirs = (Us == chess::WHITE) ? B.black_occupied : B.white_occupied;
+
+    // Only the king can answer a double check
     if(B.double_check){
-        generate_king_moves(B, moveList, capturesOnly);
+        generate_king_moves<Us, T>(B, moveList);
         return;
     }
 
-    generate_pawn_moves(B, moveList, capturesOnly);
-    generate_knight_moves(B, moveList, capturesOnly);
-    generate_orthogonal_sliders_moves(B, moveList, capturesOnly);
-    generate_diagonal_sliders_moves(B, moveList, capturesOnly);
-    generate_king_moves(B, moveList, capturesOnly);
-}
\ No newline at end of file
+    // Mask the destinations once, so the piece loops never test the mode per square
+    uint64_t target;
+    if constexpr (T == CAPTURES)                    target = theirs;
+    else if constexpr (T == EVASIONS || T == ALL)   target = ~ours;
+    else                                            target = ~B.occupied; // QUIETS, QUIET_CHECKS
+    target &= B.evasion_mask();
+
+    generate_pawn_moves<Us, T>(B, moveList, target);
+    generate_knight_moves<Us, T>(B, moveList, target);
+    generate_orthogonal_sliders_moves<Us, T>(B, moveList, target);
+    generate_diagonal_sliders_moves<Us, T>(B, moveList, target);
+    generate_king_moves<Us, T>(B, moveList);
+}
+
+MOVEGEN_INSTANTIATE(generate, const Board&, chess::MoveList&)
+
+void MoveGen::init(const Board& B, chess::MoveList& moveList, bool capturesOnly){
+    if(capturesOnly) generate<CAPTURES>(B, moveList);
+    else generate<ALL>(B, moveList);
+}
+
+bool MoveGen::is_legal(const Board& B, const chess::Move& m){
+    if(m.is_null()) return false;
+
+    const chess::Square from = (chess::Square)m.from();
+    const chess::Square to = (chess::Square)m.to();
+    const uint64_t to_bb = util::create_bitboard_from_square(to);
+    const uint64_t ours = B.white_to_move ? B.white_occupied : B.black_occupied;
+    const uint64_t theirs = B.white_to_move ? B.black_occupied : B.white_occupied;
+
+    if(!(ours & util::create_bitboard_from_square(from)) || (ours & to_bb)) return false;
+
+    const chess::PieceType piece = chess::type_of(B.board_array[from]);
+    if(B.double_check && piece != chess::KING) return false;
+
+    // Pawns and castling have too many special cases: ask their generator
+    if(piece == chess::PAWN || (m.flags() & chess::FLAG_CASTLE)){
+        chess::MoveList moves;
+        if(piece == chess::PAWN){
+            if(B.white_to_move) generate_pawn_moves<chess::WHITE, ALL>(B, moves, ~ours & B.evasion_mask());
+            else generate_pawn_moves<chess::BLACK, ALL>(B, moves, ~ours & B.evasion_mask());
+        }
+        else if(B.white_to_move) generate_king_moves<chess::WHITE, ALL>(B, moves);
+        else generate_king_moves<chess::BLACK, ALL>(B, moves);
+        return std::any_of(moves.begin(), moves.end(), [&](const chess::Move& g) { return g.m == m.m; });
+    }
+
+    if(m.flags() != ((theirs & to_bb) ? chess::FLAG_CAPTURE : chess::FLAG_QUIET) || m.promo() != chess::NO_PIECE) return false;
+
+    if(piece == chess::KING) return (chess::KingAttacks[from] & to_bb) && B.king_move_safe(to);
+
+    // Everything else must resolve a check and stay on its pin line
+    if(!(B.evasion_mask() & B.pin_mask(from) & to_bb)) return false;
+
+    switch(piece){
+        case chess::KNIGHT: return chess::KnightAttacks[from] & to_bb;
+        case chess::BISHOP: return chess::get_diagonal_slider_attacks(from, B.occupied) & to_bb;
+        case chess::ROOK:   return chess::get_orthogonal_slider_attacks(from, B.occupied) & to_bb;
+        case chess::QUEEN:  return (chess::get_diagonal_slider_attacks(from, B.occupied) | chess::get_orthogonal_slider_attacks(from, B.occupied)) & to_bb;
+        default:            return false;
+    }
+}
@@ -1,36 +1,71 @@
 #include "chess/movegen.h"
 
-void generate_king_moves_no_castle(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly){
-    const chess::Color color = B.white_to_move ? chess::WHITE : chess::BLACK;
+// Squares our king may not step on: everything the opponent attacks, plus the squares behind
+// the king on the line of a checking slider (the attack map sees the king as a blocker)
+template<chess::Color Us>
+uint64_t king_danger(const Board& B, chess::Square king_sq){
+    constexpr chess::Color Them = (Us == chess::WHITE) ? chess::BLACK : chess::WHITE;
+    uint64_t danger = B.attacks_by(Them);
+
+    uint64_t slider_checkers = B.checks & ~B.bitboard[chess::make_piece(Them, chess::KNIGHT)] & ~B.bitboard[chess::make_piece(Them, chess::PAWN)];
+    while (slider_checkers){
+        const chess::Square checker = util::pop_lsb(slider_checkers);
+        danger |= chess::Line[king_sq][checker] & ~util::create_bitboard_from_square(checker);
+    }
+    return danger;
+}
+
+template<chess::Color Us>
+void generate_king_moves_no_castle(const Board& B, chess::MoveList& moveList, uint64_t target){
+    constexpr chess::Color color = Us;
+    const uint64_t theirs = color ? B.white_occupied : B.black_occupied;
     uint64_t kingBitboard = B.bitboard[chess::make_piece(color, chess::KING)];
     while (kingBitboard){
         const chess::Square currKingSquare = util::pop_lsb(kingBitboard);
-        uint64_t attacks = chess::KingAttacks[currKingSquare];
-        uint64_t quietMoves = attacks & (~B.occupied);
-
-        if(!capturesOnly)
-        {
-            while (quietMoves){
-                const chess::Square destinationKingSquare = util::pop_lsb(quietMoves);
-                if (B.square_attacked(destinationKingSquare, color)) continue;
-                chess::Move m(currKingSquare, destinationKingSquare, chess::FLAG_QUIET, chess::NO_PIECE);
-                moveList.push_back(m);
-            }
-        }
+        uint64_t moves = chess::KingAttacks[currKingSquare] & target;
 
-        uint64_t captures = (attacks & (color ? B.white_occupied : B.black_occupied));
+        // Building the attack map costs more than testing a few squares, so only use one the node already has
+        const bool use_map = B.has_attack_map((color == chess::WHITE) ? chess::BLACK : chess::WHITE);
+        if (use_map) moves &= ~king_danger<Us>(B, currKingSquare);
 
-        while (captures){
-            const chess::Square destinationKingSquare = util::pop_lsb(captures);
-            if (B.square_attacked(destinationKingSquare, color)) continue;
-            chess::Move m(currKingSquare, destinationKingSquare, chess::FLAG_CAPTURE, chess::NO_PIECE);
+        while (moves){
+            const chess::Square destinationKingSquare = util::pop_lsb(moves);
+            if (!use_map && !B.king_move_safe(destinationKingSquare)) continue;
+            const chess::MoveFlag flag = (util::create_bitboard_from_square(destinationKingSquare) & theirs) ? chess::FLAG_CAPTURE : chess::FLAG_QUIET;
+            chess::Move m(currKingSquare, destinationKingSquare, flag, chess::NO_PIECE);
             moveList.push_back(m);
         }
     }
 }
 
-void generate_king_moves_castle(const Board& B, std::vector<chess::Move>& moveList) {
-    const chess::Color color = B.white_to_move ? chess::WHITE : chess::BLACK;
+// Is either castling square attacked? Same trade-off as for king steps: a map only if the node has one
+template<chess::Color Us>
+bool castling_path_attacked(const Board& B, chess::Square sq1, chess::Square sq2) {
+    constexpr chess::Color Them = (Us == chess::WHITE) ? chess::BLACK : chess::WHITE;
+    if (B.has_attack_map(Them))
+        return B.attacks_by(Them) & (util::create_bitboard_from_square(sq1) | util::create_bitboard_from_square(sq2));
+    return B.square_attacked(sq1, Them == chess::WHITE) || B.square_attacked(sq2, Them == chess::WHITE);
+}
+
+// Does castling with the rook going from rook_from to rook_to check the enemy king?
+template<chess::Color Us>
+bool castle_gives_check(const Board& B, chess::Square king_from, chess::Square king_to, chess::Square rook_from, chess::Square rook_to) {
+    constexpr chess::Color color = Us;
+    const chess::Square their_king = (Us == chess::WHITE) ? B.black_king_sq : B.white_king_sq;
+    const uint64_t occupancy = (B.occupied ^ util::create_bitboard_from_square(king_from) ^ util::create_bitboard_from_square(rook_from))
+                             | util::create_bitboard_from_square(king_to) | util::create_bitboard_from_square(rook_to);
+
+    const uint64_t queens = B.bitboard[chess::make_piece(color, chess::QUEEN)];
+    const uint64_t orthogonal = ((B.bitboard[chess::make_piece(color, chess::ROOK)] ^ util::create_bitboard_from_square(rook_from)) | util::create_bitboard_from_square(rook_to)) | queens;
+    const uint64_t diagonal = B.bitboard[chess::make_piece(color, chess::BISHOP)] | queens;
+
+    return (chess::get_orthogonal_slider_attacks(their_king, occupancy) & orthogonal)
+         | (chess::get_diagonal_slider_attacks(their_king, occupancy) & diagonal);
+}
+
+template<chess::Color Us, MoveGen::GenType T>
+void generate_king_moves_castle(const Board& B, chess::MoveList& moveList) {
+    constexpr chess::Color color = Us;
 
     const chess::Square king_start_sq = (color == chess::WHITE) ? chess::E1 : chess::E8;
     
@@ -44,27 +79,47 @@ void generate_king_moves_castle(const Board& B, std::vector<chess::Move>& moveLi
     const chess::Square qside_transit_sq1 = (color == chess::WHITE) ? chess::D1 : chess::D8;
     const chess::Square qside_transit_sq2 = (color == chess::WHITE) ? chess::C1 : chess::C8; 
 
-    //You can not castle out of check
-    if (B.square_attacked(king_start_sq, color)) {
+    //You can not castle out of check. Otherwise no slider looks through the king and the plain attack map is exact.
+    if (B.checks) {
         return;
     }
     
     // Kingside Castle
     if ((B.castle_rights & kside_right) && ((B.occupied & kside_empty_mask) == 0)) {
-        if (!B.square_attacked(kside_transit_sq, color) && !B.square_attacked(kside_dest_sq, color)) {
+        if (!castling_path_attacked<Us>(B, kside_transit_sq, kside_dest_sq) &&
+            (T != MoveGen::QUIET_CHECKS || castle_gives_check<Us>(B, king_start_sq, kside_dest_sq, (chess::Square)(king_start_sq + 3), kside_transit_sq))) {
             moveList.push_back(chess::Move(king_start_sq, kside_dest_sq, chess::FLAG_CASTLE, chess::NO_PIECE));
         }
     }
 
     // Queenside Castle
     if ((B.castle_rights & qside_right) && ((B.occupied & qside_empty_mask) == 0)) {
-        if (!B.square_attacked(qside_transit_sq1, color) && !B.square_attacked(qside_transit_sq2, color)) {
+        if (!castling_path_attacked<Us>(B, qside_transit_sq1, qside_transit_sq2) &&
+            (T != MoveGen::QUIET_CHECKS || castle_gives_check<Us>(B, king_start_sq, qside_transit_sq2, (chess::Square)(king_start_sq - 4), qside_transit_sq1))) {
             moveList.push_back(chess::Move(king_start_sq, qside_transit_sq2, chess::FLAG_CASTLE, chess::NO_PIECE));
         }
     }
 }
 
-void MoveGen::generate_king_moves(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly){
-    generate_king_moves_no_castle(B,moveList,capturesOnly);
-    if(!capturesOnly) generate_king_moves_castle(B,moveList);
+template<chess::Color Us, MoveGen::GenType T>
+void MoveGen::generate_king_moves(const Board& B, chess::MoveList& moveList){
+    const uint64_t ours = (Us == chess::WHITE) ? B.white_occupied : B.black_occupied;
+    const uint64_t theirs = (Us == chess::WHITE) ? B.black_occupied : B.white_occupied;
+    const chess::Square king_sq = (Us == chess::WHITE) ? B.white_king_sq : B.black_king_sq;
+
+    uint64_t target;
+    if constexpr (T == CAPTURES)                  target = theirs;
+    else if constexpr (T == EVASIONS || T == ALL) target = ~ours;
+    else if constexpr (T == QUIETS)               target = ~B.occupied;
+    else {
+        // The king never checks by itself, only by uncovering a slider
+        const chess::Square their_king = (Us == chess::WHITE) ? B.black_king_sq : B.white_king_sq;
+        target = (B.discovered_check_candidates() & util::create_bitboard_from_square(king_sq))
+               ? ~B.occupied & ~chess::Line[their_king][king_sq] : 0ULL;
+    }
+    generate_king_moves_no_castle<Us>(B, moveList, target);
+
+    if constexpr (T == QUIETS || T == QUIET_CHECKS || T == ALL) generate_king_moves_castle<Us, T>(B, moveList);
 }
+
+MOVEGEN_INSTANTIATE(generate_king_moves, const Board&, chess::MoveList&)
@@ -1,20 +1,32 @@
 #include "chess/movegen.h"
 
-void MoveGen::generate_knight_moves(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly){
-    const chess::Color color = B.white_to_move ? chess::WHITE : chess::BLACK;
-    uint64_t knightBitboard = B.bitboard[chess::make_piece(color, chess::KNIGHT)];
+template<chess::Color Us, MoveGen::GenType T>
+void MoveGen::generate_knight_moves(const Board& B, chess::MoveList& moveList, uint64_t target){
+    const uint64_t theirs = (Us == chess::WHITE) ? B.black_occupied : B.white_occupied;
+    uint64_t knightBitboard = B.bitboard[chess::make_piece(Us, chess::KNIGHT)];
+
+    // A knight never stays on the line it leaves, so every move of a discoverer checks
+    const uint64_t discoverers = (T == QUIET_CHECKS) ? B.discovered_check_candidates() : 0ULL;
+    const uint64_t direct_checks = (T == QUIET_CHECKS) ? B.check_squares(chess::KNIGHT) : ~0ULL;
+
     while (knightBitboard){
         const chess::Square currKnightSquare = util::pop_lsb(knightBitboard);
-        uint64_t attacks = chess::KnightAttacks[currKnightSquare] & ~(color ? B.black_occupied : B.white_occupied);
+        // A pinned knight can never stay on the pin line
+        if (B.pinned_pieces() & util::create_bitboard_from_square(currKnightSquare)) continue;
+
+        uint64_t attacks = chess::KnightAttacks[currKnightSquare] & target;
+        if constexpr (T == QUIET_CHECKS) {
+            if (!(discoverers & util::create_bitboard_from_square(currKnightSquare))) attacks &= direct_checks;
+        }
 
         while (attacks){
             const chess::Square destinationKnightSquare = util::pop_lsb(attacks);
-            const chess::MoveFlag flag = (util::create_bitboard_from_square(destinationKnightSquare) & (color ? B.white_occupied : B.black_occupied)) ? chess::FLAG_CAPTURE : chess::FLAG_QUIET; 
-
-            if(capturesOnly && flag == chess::FLAG_QUIET) continue;
+            const chess::MoveFlag flag = (util::create_bitboard_from_square(destinationKnightSquare) & theirs) ? chess::FLAG_CAPTURE : chess::FLAG_QUIET; 
 
             chess::Move m(currKnightSquare, destinationKnightSquare, flag, chess::NO_PIECE);
             moveList.push_back(m);
         }
     }
-}
\ No newline at end of file
+}
+
+MOVEGEN_INSTANTIATE(generate_knight_moves, const Board&, chess::MoveList&, uint64_t)
@@ -1,19 +1,30 @@
 #include "chess/movegen.h"
 
-void MoveGen::generate_orthogonal_sliders_moves(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly){
-    chess::Color color = B.white_to_move ? chess::WHITE : chess::BLACK;
-    uint64_t orthogonal_sliders = (B.bitboard[chess::make_piece(color, chess::ROOK)] | B.bitboard[chess::make_piece(color, chess::QUEEN)]);
+template<chess::Color Us, MoveGen::GenType T>
+void MoveGen::generate_orthogonal_sliders_moves(const Board& B, chess::MoveList& moveList, uint64_t target){
+    const uint64_t theirs = (Us == chess::WHITE) ? B.black_occupied : B.white_occupied;
+    uint64_t orthogonal_sliders = (B.bitboard[chess::make_piece(Us, chess::ROOK)] | B.bitboard[chess::make_piece(Us, chess::QUEEN)]);
+
+    const uint64_t discoverers = (T == QUIET_CHECKS) ? B.discovered_check_candidates() : 0ULL;
+    const chess::Square their_king = (Us == chess::WHITE) ? B.black_king_sq : B.white_king_sq;
+
     while (orthogonal_sliders){
         const chess::Square from_sq = util::pop_lsb(orthogonal_sliders);
         
-        uint64_t attacks = get_orthogonal_slider_attacks(from_sq, B.occupied) & (color ? (~B.black_occupied) : (~B.white_occupied));
+        uint64_t attacks = get_orthogonal_slider_attacks(from_sq, B.occupied) & target & B.pin_mask(from_sq);
+        if constexpr (T == QUIET_CHECKS) {
+            uint64_t checking = B.check_squares(chess::type_of(B.board_array[from_sq]));
+            if (discoverers & util::create_bitboard_from_square(from_sq)) checking |= ~chess::Line[their_king][from_sq];
+            attacks &= checking;
+        }
+
         while (attacks) {
             const chess::Square to_sq = util::pop_lsb(attacks);
-            chess::MoveFlag flag = (util::create_bitboard_from_square(to_sq) & (color ? B.white_occupied : B.black_occupied)) ? chess::FLAG_CAPTURE : chess::FLAG_QUIET;
-            
-            if(capturesOnly && (flag == chess::FLAG_QUIET)) continue;
+            chess::MoveFlag flag = (util::create_bitboard_from_square(to_sq) & theirs) ? chess::FLAG_CAPTURE : chess::FLAG_QUIET;
 
             moveList.push_back(chess::Move(from_sq, to_sq, flag, chess::NO_PIECE));
         }
     }
 }
+
+MOVEGEN_INSTANTIATE(generate_orthogonal_sliders_moves, const Board&, chess::MoveList&, uint64_t)
@@ -1,167 +1,190 @@
 #include "chess/movegen.h"
 
-void add_pawn_promotion_moves(const Board& B, const chess::Square currSq, const chess::Square dstSq, const chess::MoveFlag flags, std::vector<chess::Move>& moveList)
+// Everything that depends on the side to move is a compile time constant here
+template<chess::Color Us>
+struct PawnDirs {
+    static constexpr chess::Color Them = (Us == chess::WHITE) ? chess::BLACK : chess::WHITE;
+    static constexpr chess::Direction Push = (Us == chess::WHITE) ? chess::NORTH : chess::SOUTH;
+    static constexpr chess::Direction CaptureWest = (Us == chess::WHITE) ? chess::NORTH_WEST : chess::SOUTH_WEST;
+    static constexpr chess::Direction CaptureEast = (Us == chess::WHITE) ? chess::NORTH_EAST : chess::SOUTH_EAST;
+    static constexpr int PushDelta = (Us == chess::WHITE) ? 8 : -8;
+    static constexpr int WestDelta = (Us == chess::WHITE) ? 7 : -9;
+    static constexpr int EastDelta = (Us == chess::WHITE) ? 9 : -7;
+    static constexpr uint64_t StartRank = (Us == chess::WHITE) ? util::Rank2 : util::Rank7;
+    static constexpr uint64_t PromotionRank = (Us == chess::WHITE) ? util::Rank7 : util::Rank2; // pawns about to promote
+    static constexpr chess::Piece Pawn = (Us == chess::WHITE) ? chess::WP : chess::BP;
+};
+
+template<chess::Color Us>
+void add_pawn_promotion_moves(const chess::Square currSq, const chess::Square dstSq, const chess::MoveFlag flags, chess::MoveList& moveList)
 {
-    const std::vector<chess::PieceType> pieces = {chess::KNIGHT, chess::BISHOP, chess::ROOK, chess::QUEEN};
-    const chess::Color color = B.white_to_move ? chess::WHITE : chess::BLACK;
+    static constexpr chess::PieceType pieces[] = {chess::KNIGHT, chess::BISHOP, chess::ROOK, chess::QUEEN};
 
     for (const auto piece : pieces)
     {
-        chess::Move m(currSq, dstSq, flags, chess::make_piece(color, piece));
+        chess::Move m(currSq, dstSq, flags, chess::make_piece(Us, piece));
         moveList.push_back(m);
     }
 }
 
-void generate_pawn_single_push(const Board& B, std::vector<chess::Move>& moveList)
+template<chess::Color Us>
+void generate_pawn_single_push(const Board& B, chess::MoveList& moveList, uint64_t our_pawns, uint64_t target)
 {
-    const uint64_t our_pawns = B.white_to_move ? B.bitboard[chess::WP] : B.bitboard[chess::BP];
-    const uint64_t empty_squares = ~B.occupied;
-    const chess::Direction push_dir = B.white_to_move ? chess::NORTH : chess::SOUTH;
-    const chess::Direction pull_dir = B.white_to_move ? chess::SOUTH : chess::NORTH;
-
-    const uint64_t pawns_to_push = B.white_to_move ? (our_pawns & ~util::Rank7) : (our_pawns & ~util::Rank2);
+    using D = PawnDirs<Us>;
+    const uint64_t pawns_to_push = our_pawns & ~D::PromotionRank;
 
-    uint64_t destinations = util::shift_board(pawns_to_push, push_dir) & empty_squares;
+    uint64_t destinations = util::shift_board(pawns_to_push, D::Push) & ~B.occupied & target;
 
     while (destinations)
     {
         const chess::Square to = util::pop_lsb(destinations);
-        const chess::Square from = util::shift_square(to, pull_dir);
+        const chess::Square from = (chess::Square)(to - D::PushDelta);
+        if (!(B.pin_mask(from) & util::create_bitboard_from_square(to))) continue;
         moveList.push_back(chess::Move(from, to, chess::FLAG_QUIET, chess::NO_PIECE));
     }
 }
 
-void generate_push_double_push(const Board& B, std::vector<chess::Move>& moveList)
+template<chess::Color Us>
+void generate_push_double_push(const Board& B, chess::MoveList& moveList, uint64_t our_pawns, uint64_t target)
 {
-    const uint64_t our_pawns = B.white_to_move ? B.bitboard[chess::WP] : B.bitboard[chess::BP];
+    using D = PawnDirs<Us>;
     const uint64_t empty_squares = ~B.occupied;
-    const chess::Direction push_dir = B.white_to_move ? chess::NORTH : chess::SOUTH;
-    const chess::Direction pull_dir = B.white_to_move ? chess::SOUTH : chess::NORTH;
 
-    const uint64_t pawns_on_start_rank = B.white_to_move ? (our_pawns & util::Rank2) : (our_pawns & util::Rank7);
-
-    const uint64_t pushes1 = util::shift_board(pawns_on_start_rank, push_dir) & empty_squares;
-    uint64_t destinations = util::shift_board(pushes1, push_dir) & empty_squares;
+    const uint64_t pushes1 = util::shift_board(our_pawns & D::StartRank, D::Push) & empty_squares;
+    uint64_t destinations = util::shift_board(pushes1, D::Push) & empty_squares & target;
 
     while (destinations)
     {
         const chess::Square to = util::pop_lsb(destinations);
-        const chess::Square from = util::shift_square(util::shift_square(to, pull_dir), pull_dir);
+        const chess::Square from = (chess::Square)(to - 2 * D::PushDelta);
+        if (!(B.pin_mask(from) & util::create_bitboard_from_square(to))) continue;
         moveList.push_back(chess::Move(from, to, chess::FLAG_DOUBLE_PUSH, chess::NO_PIECE));
     }
 }
 
-void generate_pawn_captures(const Board& B, std::vector<chess::Move>& moveList)
+template<chess::Color Us>
+void generate_pawn_captures(const Board& B, chess::MoveList& moveList, uint64_t target)
 {
-    const uint64_t our_pawns = B.white_to_move ? B.bitboard[chess::WP] : B.bitboard[chess::BP];
-    const uint64_t opponent_pieces = B.white_to_move ? B.black_occupied
-                                                     : B.white_occupied;
-
-    const uint64_t pawns_to_capture = B.white_to_move ? (our_pawns & ~util::Rank7)
-                                                     : (our_pawns & ~util::Rank2);
+    using D = PawnDirs<Us>;
+    const uint64_t pawns_to_capture = B.bitboard[D::Pawn] & ~D::PromotionRank;
+    const uint64_t opponent_pieces = (Us == chess::WHITE) ? B.black_occupied : B.white_occupied;
 
-    const chess::Direction dir1 = B.white_to_move ? chess::NORTH_WEST : chess::SOUTH_WEST;
-    const chess::Direction pull_dir1 = B.white_to_move ? chess::SOUTH_EAST : chess::NORTH_EAST;
-    uint64_t captures1 = util::shift_board(pawns_to_capture, dir1) & opponent_pieces;
+    uint64_t captures1 = util::shift_board(pawns_to_capture, D::CaptureWest) & opponent_pieces & target;
 
     while (captures1)
     {
         const chess::Square to = util::pop_lsb(captures1);
-        const chess::Square from = util::shift_square(to, pull_dir1);
+        const chess::Square from = (chess::Square)(to - D::WestDelta);
+        if (!(B.pin_mask(from) & util::create_bitboard_from_square(to))) continue;
         moveList.push_back(chess::Move(from, to, chess::FLAG_CAPTURE, chess::NO_PIECE));
     }
 
-    const chess::Direction dir2 = B.white_to_move ? chess::NORTH_EAST : chess::SOUTH_EAST;
-    const chess::Direction pull_dir2 = B.white_to_move ? chess::SOUTH_WEST : chess::NORTH_WEST;
-    uint64_t captures2 = util::shift_board(pawns_to_capture, dir2) & opponent_pieces;
+    uint64_t captures2 = util::shift_board(pawns_to_capture, D::CaptureEast) & opponent_pieces & target;
 
     while (captures2)
     {
         const chess::Square to = util::pop_lsb(captures2);
-        const chess::Square from = util::shift_square(to, pull_dir2);
+        const chess::Square from = (chess::Square)(to - D::EastDelta);
+        if (!(B.pin_mask(from) & util::create_bitboard_from_square(to))) continue;
         moveList.push_back(chess::Move(from, to, chess::FLAG_CAPTURE, chess::NO_PIECE));
     }
 }
 
-void generate_pawn_promotion(const Board& B, std::vector<chess::Move>& moveList)
+template<chess::Color Us>
+void generate_pawn_promotion(const Board& B, chess::MoveList& moveList, uint64_t target)
 {
-    const uint64_t our_pawns = B.white_to_move ? B.bitboard[chess::WP] : B.bitboard[chess::BP];
-    const uint64_t empty_squares = ~B.occupied;
-    const chess::Direction push_dir = B.white_to_move ? chess::NORTH : chess::SOUTH;
-    const chess::Direction pull_dir = B.white_to_move ? chess::SOUTH : chess::NORTH;
-
-    const uint64_t promoting_pawns = B.white_to_move ? (our_pawns & util::Rank7) : (our_pawns & util::Rank2);
+    using D = PawnDirs<Us>;
+    const uint64_t promoting_pawns = B.bitboard[D::Pawn] & D::PromotionRank;
 
-    uint64_t destinations = util::shift_board(promoting_pawns, push_dir) & empty_squares;
+    uint64_t destinations = util::shift_board(promoting_pawns, D::Push) & ~B.occupied & target;
 
     while (destinations)
     {
         const chess::Square to = util::pop_lsb(destinations);
-        const chess::Square from = util::shift_square(to, pull_dir);
-        add_pawn_promotion_moves(B, from, to, chess::FLAG_PROMO, moveList);
+        const chess::Square from = (chess::Square)(to - D::PushDelta);
+        if (!(B.pin_mask(from) & util::create_bitboard_from_square(to))) continue;
+        add_pawn_promotion_moves<Us>(from, to, chess::FLAG_PROMO, moveList);
     }
 }
 
-void generate_pawn_ep_captures(const Board& B, std::vector<chess::Move>& moveList)
+template<chess::Color Us>
+void generate_pawn_ep_captures(const Board& B, chess::MoveList& moveList)
 {
     if (B.en_passant_sq == chess::SQUARE_NONE) return;
 
-    const uint64_t our_pawns = B.white_to_move ? B.bitboard[chess::WP] : B.bitboard[chess::BP];
-    
     // Find which of our pawns attack the en passant square.
     // Putting an opposite color pawn in place of en passant square to get friendly pawns which can attack that square
-    uint64_t attackers = chess::PawnAttacks[B.white_to_move][B.en_passant_sq];
-    uint64_t attacking_pawns = attackers & our_pawns;
+    uint64_t attacking_pawns = chess::PawnAttacks[PawnDirs<Us>::Them][B.en_passant_sq] & B.bitboard[PawnDirs<Us>::Pawn];
 
     while (attacking_pawns)
     {
         const chess::Square from = util::pop_lsb(attacking_pawns);
+        if (!B.ep_capture_legal(from)) continue;
         moveList.push_back(chess::Move(from, B.en_passant_sq, chess::FLAG_EP, chess::NO_PIECE));
     }
 }
 
-void generate_pawn_promotion_captures(const Board& B, std::vector<chess::Move>& moveList)
+template<chess::Color Us>
+void generate_pawn_promotion_captures(const Board& B, chess::MoveList& moveList, uint64_t target)
 {
-    const uint64_t our_pawns = B.white_to_move ? B.bitboard[chess::WP] : B.bitboard[chess::BP];
-    const uint64_t opponent_pieces = B.white_to_move ? B.black_occupied
-                                                     : B.white_occupied;
-    
-    const uint64_t promoting_pawns = B.white_to_move ? (our_pawns & util::Rank7)
-                                                     : (our_pawns & util::Rank2);
+    using D = PawnDirs<Us>;
+    const uint64_t promoting_pawns = B.bitboard[D::Pawn] & D::PromotionRank;
+    const uint64_t opponent_pieces = (Us == chess::WHITE) ? B.black_occupied : B.white_occupied;
 
-    const chess::Direction dir1 = B.white_to_move ? chess::NORTH_WEST : chess::SOUTH_WEST;
-    const chess::Direction pull_dir1 = B.white_to_move ? chess::SOUTH_EAST : chess::NORTH_EAST;
-    uint64_t captures1 = util::shift_board(promoting_pawns, dir1) & opponent_pieces;
+    uint64_t captures1 = util::shift_board(promoting_pawns, D::CaptureWest) & opponent_pieces & target;
 
     while (captures1)
     {
         const chess::Square to = util::pop_lsb(captures1);
-        const chess::Square from = util::shift_square(to, pull_dir1);
-        add_pawn_promotion_moves(B, from, to, chess::FLAG_CAPTURE_PROMO, moveList);
+        const chess::Square from = (chess::Square)(to - D::WestDelta);
+        if (!(B.pin_mask(from) & util::create_bitboard_from_square(to))) continue;
+        add_pawn_promotion_moves<Us>(from, to, chess::FLAG_CAPTURE_PROMO, moveList);
     }
 
-    const chess::Direction dir2 = B.white_to_move ? chess::NORTH_EAST : chess::SOUTH_EAST;
-    const chess::Direction pull_dir2 = B.white_to_move ? chess::SOUTH_WEST : chess::NORTH_WEST;
-    uint64_t captures2 = util::shift_board(promoting_pawns, dir2) & opponent_pieces;
+    uint64_t captures2 = util::shift_board(promoting_pawns, D::CaptureEast) & opponent_pieces & target;
 
     while (captures2)
     {
         const chess::Square to = util::pop_lsb(captures2);
-        const chess::Square from = util::shift_square(to, pull_dir2);
-        add_pawn_promotion_moves(B, from, to, chess::FLAG_CAPTURE_PROMO, moveList);
+        const chess::Square from = (chess::Square)(to - D::EastDelta);
+        if (!(B.pin_mask(from) & util::create_bitboard_from_square(to))) continue;
+        add_pawn_promotion_moves<Us>(from, to, chess::FLAG_CAPTURE_PROMO, moveList);
     }
 }
 
-void MoveGen::generate_pawn_moves(const Board& B, std::vector<chess::Move>& moveList, bool capturesOnly)
+template<chess::Color Us, MoveGen::GenType T>
+void MoveGen::generate_pawn_moves(const Board& B, chess::MoveList& moveList, uint64_t target)
 {
-    generate_pawn_captures(B, moveList);
-    generate_pawn_ep_captures(B, moveList);
-    generate_pawn_promotion_captures(B, moveList);
+    if constexpr (T != QUIETS && T != QUIET_CHECKS)
+    {
+        generate_pawn_captures<Us>(B, moveList, target);
+        generate_pawn_ep_captures<Us>(B, moveList);
+        generate_pawn_promotion_captures<Us>(B, moveList, target);
+    }
+
+    const uint64_t our_pawns = B.bitboard[PawnDirs<Us>::Pawn];
 
-    if(!capturesOnly)
+    if constexpr (T == QUIETS || T == EVASIONS || T == ALL)
     {
-        generate_pawn_single_push(B, moveList);
-        generate_push_double_push(B, moveList);
-        generate_pawn_promotion(B, moveList);
+        generate_pawn_single_push<Us>(B, moveList, our_pawns, target);
+        generate_push_double_push<Us>(B, moveList, our_pawns, target);
+        generate_pawn_promotion<Us>(B, moveList, target);
     }
-}
\ No newline at end of file
+
+    if constexpr (T == QUIET_CHECKS)
+    {
+        // Direct checks: the pushed pawn attacks the king
+        const uint64_t discoverers = B.discovered_check_candidates();
+        const uint64_t direct = target & B.check_squares(chess::PAWN);
+        generate_pawn_single_push<Us>(B, moveList, our_pawns & ~discoverers, direct);
+        generate_push_double_push<Us>(B, moveList, our_pawns & ~discoverers, direct);
+
+        // Discovered checks: any push off the line, i.e. unless the pawn shares the king's file
+        const chess::Square their_king = (Us == chess::WHITE) ? B.black_king_sq : B.white_king_sq;
+        const uint64_t uncovering = our_pawns & discoverers & ~(util::FileA << (their_king & 7));
+        generate_pawn_single_push<Us>(B, moveList, uncovering, target);
+        generate_push_double_push<Us>(B, moveList, uncovering, target);
+    }
+}
+
+MOVEGEN_INSTANTIATE(generate_pawn_moves, const Board&, chess::MoveList&, uint64_t)
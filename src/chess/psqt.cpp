@@ -0,0 +1,121 @@
+#include "chess/psqt.h"
+#include "chess/util.h"
+
+namespace {
+
+// Tapered values as written below; the table packs them into one psqt::Score per piece and square
+struct Value {
+    int mg = 0;
+    int eg = 0;
+};
+
+// Material values for each piece type
+constexpr std::array<Value, chess::PIECE_TYPE_NB> material = {{
+    {0, 0},   // NO_PIECE_TYPE
+    {80, 120},   // PAWN
+    {320, 320},   // KNIGHT
+    {330, 360},   // BISHOP
+    {500, 650},   // ROOK
+    {900, 1000},  // QUEEN
+    {0, 0}      // KING (material value is infinite/not counted)
+}};
+
+// Piece-Square Tables, indexed by [PieceType][Square] from White's point of view
+constexpr std::array<std::array<Value, chess::SQUARE_NB>, chess::PIECE_TYPE_NB> pst = {{
+    // No Piece PST
+    {{ //     A          B           C           D           E           F           G           H
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, // Rank 1
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, // Rank 2
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, // Rank 3
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, // Rank 4
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, // Rank 5
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, // Rank 6
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, // Rank 7
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}  // Rank 8
+    }},
+    // PAWN PST
+    {{ //     A          B           C           D           E           F           G           H
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0},  // Rank 1
+        {  5,  10}, { 10,  10}, { 10,  10}, {-20,  10}, {-20,  10}, { 10,  10}, { 10,  10}, {  5,  10}, // Rank 2
+        {  5,  10}, { -5,  10}, {-10,  10}, {  0,  10}, {  0,  10}, {-10,  10}, { -5,  10}, {  5,  10}, // Rank 3
+        {  0,  20}, {  0,  20}, {  0,  20}, { 20,  20}, { 20,  20}, {  0,  20}, {  0,  20}, {  0,  20}, // Rank 4
+        {  5,  30}, {  5,  30}, { 10,  30}, { 25,  30}, { 25,  30}, { 10,  30}, {  5,  30}, {  5,  30}, // Rank 5
+        { 10,  50}, { 10,  50}, { 20,  50}, { 30,  50}, { 30,  50}, { 20,  50}, { 10,  50}, { 10,  50}, // Rank 6
+        { 50,  80}, { 50,  80}, { 50,  80}, { 50,  80}, { 50,  80}, { 50,  80}, { 50,  80}, { 50,  80}, // Rank 7
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0} // Rank 8
+    }},
+    // KNIGHT PST
+    {{ //     A          B           C           D           E           F           G           H
+        {-50, -50}, {-40, -30}, {-30, -20}, {-30, -20}, {-30, -20}, {-30, -20}, {-40, -30}, {-50, -50}, // Rank 1
+        {-40, -30}, {-20, -10}, {  0,   0}, {  0,   5}, {  0,   5}, {  0,   0}, {-20, -10}, {-40, -30}, // Rank 2
+        {-30, -20}, {  0,   0}, { 10,  10}, { 15,  15}, { 15,  15}, { 10,  10}, {  0,   0}, {-30, -20}, // Rank 3
+        {-30, -20}, {  5,   5}, { 15,  15}, { 20,  20}, { 20,  20}, { 15,  15}, {  5,   5}, {-30, -20}, // Rank 4
+        {-30, -20}, {  0,   5}, { 15,  15}, { 20,  20}, { 20,  20}, { 15,  15}, {  0,   5}, {-30, -20}, // Rank 5
+        {-30, -20}, {  5,   0}, { 10,  10}, { 15,  15}, { 15,  15}, { 10,  10}, {  5,   0}, {-30, -20}, // Rank 6
+        {-40, -30}, {-20, -10}, {  0,   0}, {  5,   5}, {  5,   5}, {  0,   0}, {-20, -10}, {-40, -30}, // Rank 7
+        {-50, -50}, {-40, -30}, {-30, -20}, {-30, -20}, {-30, -20}, {-30, -20}, {-40, -30}, {-50, -50}  // Rank 8
+    }},
+    // BISHOP PST
+    {{ //     A          B           C           D           E           F           G           H
+        {-20, -20}, {-10, -10}, {-10, -10}, {-10, -10}, {-10, -10}, {-10, -10}, {-10, -10}, {-20, -20}, // Rank 1
+        {-10, -10}, { 30,  20}, {  0,   5}, {  5,   5}, {  5,   5}, {  0,   5}, { 30,  20}, {-10, -10}, // Rank 2
+        {-10, -10}, {  0,   5}, {  8,  10}, { 10,  10}, { 10,  10}, {  8,  10}, {  0,   5}, {-10, -10}, // Rank 3
+        {-10, -10}, {  5,   5}, { 10,  10}, { 12,  12}, { 12,  12}, { 10,  10}, {  5,   5}, {-10, -10}, // Rank 4
+        {-10, -10}, {  5,   5}, { 10,  10}, { 12,  12}, { 12,  12}, { 10,  10}, {  5,   5}, {-10, -10}, // Rank 5
+        {-10, -10}, {  0,   5}, {  8,  10}, { 10,  10}, { 10,  10}, {  8,  10}, {  0,   5}, {-10, -10}, // Rank 6
+        {-10, -10}, { 12,  12}, {  0,   5}, {  5,   5}, {  5,   5}, {  0,   5}, { 12,  12}, {-10, -10}, // Rank 7
+        {-20, -20}, {-10, -10}, {-10, -10}, {-10, -10}, {-10, -10}, {-10, -10}, {-10, -10}, {-20, -20}  // Rank 8
+    }},
+    // ROOK PST
+    {{ //     A          B           C           D           E           F           G           H
+        {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, {  0,   0}, // Rank 1
+        { -5,  10}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, { -5,  10}, // Rank 2
+        { -5,  10}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, { -5,  10}, // Rank 3
+        { -5,  10}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, { -5,  10}, // Rank 4
+        { -5,  10}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, { -5,  10}, // Rank 5
+        { -5,  10}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, {  0,  15}, { -5,  10}, // Rank 6
+        {  5,  10}, { 10,  15}, { 10,  15}, { 10,  15}, { 10,  15}, { 10,  15}, { 10,  15}, {  5,  10}, // Rank 7
+        {  0,   0}, {  0,   0}, {  0,   0}, {  5,   0}, {  5,   0}, {  0,   0}, {  0,   0}, {  0,   0}  // Rank 8
+    }},
+    // QUEEN PST
+    {{ //     A          B           C           D           E           F           G           H
+        {-20, -30}, {-10, -20}, {-10, -10}, { -5, -10}, { -5, -10}, {-10, -10}, {-10, -20}, {-20, -30}, // Rank 1
+        {-10, -20}, {  0, -10}, {  0,   0}, {  0,   5}, {  0,   5}, {  0,   0}, {  0, -10}, {-10, -20}, // Rank 2
+        {-10, -10}, {  0,   0}, {  5,  10}, {  5,  15}, {  5,  15}, {  5,  10}, {  0,   0}, {-10, -10}, // Rank 3
+        { -5, -10}, {  0,   5}, {  5,  15}, {  5,  20}, {  5,  20}, {  5,  15}, {  0,   5}, { -5, -10}, // Rank 4
+        {  0, -10}, {  0,   5}, {  5,  15}, {  5,  20}, {  5,  20}, {  5,  15}, {  0,   5}, { -5, -10}, // Rank 5
+        {-10, -10}, {  5,   0}, {  5,  10}, {  5,  15}, {  5,  15}, {  5,  10}, {  0,   0}, {-10, -10}, // Rank 6
+        {-10, -20}, {  0, -10}, {  5,   0}, {  0,   5}, {  0,   5}, {  0,   0}, {  0, -10}, {-10, -20}, // Rank 7
+        {-20, -30}, {-10, -20}, {-10, -10}, { -5, -10}, { -5, -10}, {-10, -10}, {-10, -20}, {-20, -30}  // Rank 8
+    }},
+    // KING PST
+    {{ //     A          B           C           D           E           F           G           H
+        { 10, -50}, { 30, -30}, { 10, -20}, {  0, -10}, {  0, -10}, { 10, -20}, { 30, -30}, { 10, -50}, // Rank 1
+        {  5, -30}, { 20, -10}, {  0,   0}, {  0,  10}, {  0,   0}, {  0,   0}, { 20, -10}, {  5, -30}, // Rank 2
+        {-10,   0}, {-20,   0}, {-20,   0}, {-20,   0}, {-20,   0}, {-20,   0}, {-20,   0}, {-10,   0}, // Rank 3
+        {-20,   0}, {-30,   0}, {-30,   0}, {-40,   0}, {-40,   0}, {-30,   0}, {-30,   0}, {-20,   0}, // Rank 4
+        {-30,   0}, {-40,   0}, {-40,   0}, {-50,   0}, {-50,   0}, {-40,   0}, {-40,   0}, {-30,   0}, // Rank 5
+        {-30,   0}, {-40,   0}, {-40,   0}, {-50,   0}, {-50,   0}, {-40,   0}, {-40,   0}, {-30,   0}, // Rank 6
+        {-30,   0}, {-40,   0}, {-40,   0}, {-50,   0}, {-50,   0}, {-40,   0}, {-40,   0}, {-30,   0}, // Rank 7
+        {-30,   0}, {-40,   0}, {-40,   0}, {-50,   0}, {-50,   0}, {-40,   0}, {-40,   0}, {-30,   0}  // Rank 8
+    }}
+}};
+
+} // namespace
+
+// Material + PST for every piece and square, summed incrementally by Board
+static constexpr std::array<std::array<psqt::Score, chess::SQUARE_NB>, 16> make_psq_table() {
+    std::array<std::array<psqt::Score, chess::SQUARE_NB>, 16> table{};
+    for (int pt = chess::PAWN; pt <= chess::KING; ++pt) {
+        const Value value = material[pt];
+        for (int sq = chess::A1; sq <= chess::H8; ++sq) {
+            const Value white = pst[pt][sq];
+            const Value black = pst[pt][util::flip(chess::Square(sq))];
+            table[chess::make_piece(chess::WHITE, chess::PieceType(pt))][sq] = psqt::make_score(value.mg + white.mg, value.eg + white.eg);
+            table[chess::make_piece(chess::BLACK, chess::PieceType(pt))][sq] = -psqt::make_score(value.mg + black.mg, value.eg + black.eg);
+        }
+    }
+    return table;
+}
+
+constexpr std::array<std::array<psqt::Score, chess::SQUARE_NB>, 16> psqt::table = make_psq_table();
@@ -0,0 +1,47 @@
+#include "chess/board.h"
+
+/**
+ * @brief Fills the attack maps of colour c: per piece type and combined, plus how often each
+ * piece type hits the squares around the other king.
+ * * Sliders see the board as it is, so a square behind the king on a checking line is not
+ * included; generate_king_moves adds those itself.
+ */
+void Board::compute_threats(chess::Color c) const {
+    uint64_t* attacks = attacked_by[c];
+    uint8_t* zone_hits = king_zone_hits[c];
+    for (int pt = chess::NO_PIECE_TYPE; pt < chess::PIECE_TYPE_NB; ++pt) {
+        attacks[pt] = 0ULL;
+        zone_hits[pt] = 0;
+    }
+
+    const chess::Square their_king = (c == chess::WHITE) ? black_king_sq : white_king_sq;
+    const uint64_t zone = (their_king == chess::SQUARE_NONE) ? 0ULL : chess::KingAttacks[their_king];
+
+    // Pawns attack as a set; each shift moves every pawn at most once, so the counts stay per pawn
+    const uint64_t pawns = bitboard[chess::make_piece(c, chess::PAWN)];
+    const uint64_t west = util::shift_board(pawns, (c == chess::WHITE) ? chess::NORTH_WEST : chess::SOUTH_WEST);
+    const uint64_t east = util::shift_board(pawns, (c == chess::WHITE) ? chess::NORTH_EAST : chess::SOUTH_EAST);
+    attacks[chess::PAWN] = west | east;
+    zone_hits[chess::PAWN] = util::count_bits(west & zone) + util::count_bits(east & zone);
+
+    for (int pt = chess::KNIGHT; pt <= chess::KING; ++pt) {
+        uint64_t pieces = bitboard[chess::make_piece(c, (chess::PieceType)pt)];
+        while (pieces) {
+            const chess::Square sq = util::pop_lsb(pieces);
+            uint64_t piece_attacks;
+            switch (pt) {
+                case chess::KNIGHT: piece_attacks = chess::KnightAttacks[sq]; break;
+                case chess::BISHOP: piece_attacks = chess::get_diagonal_slider_attacks(sq, occupied); break;
+                case chess::ROOK:   piece_attacks = chess::get_orthogonal_slider_attacks(sq, occupied); break;
+                case chess::QUEEN:  piece_attacks = chess::get_diagonal_slider_attacks(sq, occupied) | chess::get_orthogonal_slider_attacks(sq, occupied); break;
+                default:            piece_attacks = chess::KingAttacks[sq]; break;
+            }
+            attacks[pt] |= piece_attacks;
+            zone_hits[pt] += util::count_bits(piece_attacks & zone);
+        }
+    }
+
+    for (int pt = chess::PAWN; pt <= chess::KING; ++pt) attacks[chess::NO_PIECE_TYPE] |= attacks[pt];
+
+    threats_known |= 1 << c;
+}
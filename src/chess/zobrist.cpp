@@ -6,7 +6,7 @@
 #include <stdexcept> // For exceptions
 
 // Polyglot Zobrist keys (random64 array)
-const uint64_t random64[781] = {
+constexpr uint64_t random64[781] = {
    0x9D39247E33776D41, 0x2AF7398005AAA5C7, 0x44DB015024623547, 0x9C15F73E62A76AE2,
    0x75834465489C0C89, 0x3290AC3A203001BF, 0x0FBBAD1F61042279, 0xE83A908FF2FB60CA,
    0x0D7E765D58755C10, 0x1A083822CEAFE02D, 0x9605D5F0E25EC3B0, 0xD021FF5CD13A2ED5,
@@ -205,10 +205,26 @@ const uint64_t random64[781] = {
    0xF8D626AAAF278509,
 };
 // --- STATIC MEMBER VARIABLE (DEFINITIONS) ---
-uint64_t Zobrist::piecesArray[12][64];
-uint64_t Zobrist::castlingRights[4];
-uint64_t Zobrist::enPassantFile[8];
-uint64_t Zobrist::sideToMove;
+// Polyglot layout: 768 piece keys, then 4 castling keys, 8 en passant files and the side to move.
+namespace {
+    template<size_t N>
+    constexpr std::array<uint64_t, N> random_keys(int offset) {
+        std::array<uint64_t, N> keys{};
+        for (size_t i = 0; i < N; ++i) keys[i] = random64[offset + i];
+        return keys;
+    }
+
+    constexpr std::array<std::array<uint64_t, 64>, 12> piece_keys() {
+        std::array<std::array<uint64_t, 64>, 12> keys{};
+        for (int i = 0; i < 12; ++i) keys[i] = random_keys<64>(i * 64);
+        return keys;
+    }
+}
+
+constexpr std::array<std::array<uint64_t, 64>, 12> Zobrist::piecesArray = piece_keys();
+constexpr std::array<uint64_t, 4> Zobrist::castlingRights = random_keys<4>(768);
+constexpr std::array<uint64_t, 8> Zobrist::enPassantFile = random_keys<8>(772);
+constexpr uint64_t Zobrist::sideToMove = random64[780];
 
 
 /**
@@ -235,25 +251,46 @@ int get_polyglot_piece_index(chess::Piece p) {
 }
 
 
-// Initialize Zobrist keys
-void Zobrist::init_zobrist_keys() {
-    const int num_pieces = 12;
+/**
+ * @brief The en passant file key, hashed only when the side to move has a pawn that
+ * could take en passant. Shared by the full hash and the null move.
+ */
+uint64_t Zobrist::en_passant_key(const Board& B)
+{
+    const uint64_t ONE = 1ULL;
 
-    for (int i = 0; i < num_pieces; ++i)
-        for (int j = 0; j < 64; ++j)
-            Zobrist::piecesArray[i][j] = random64[i * 64 + j];
+    if (B.en_passant_sq == chess::SQUARE_NONE) return 0ULL;
 
-    int offset = num_pieces * 64; // Start at index 768
-    
-    for (int i = 0; i < 4; ++i) 
-        Zobrist::castlingRights[i] = random64[offset + i]; // 768, 769, 770, 771
+    int ep_file = B.en_passant_sq % 8;
+    bool can_capture = false;
     
-    offset += 4; // Start at index 772
-    for (int i = 0; i < 8; ++i) 
-        Zobrist::enPassantFile[i] = random64[offset + i]; // 772..779
-    
-    offset += 8; // Start at index 780
-    Zobrist::sideToMove = random64[offset]; // 780
+    // Define rank masks (assuming 0=Rank1, 7=Rank8)
+    const uint64_t RANK_4_MASK = 0xFF000000ULL;
+    const uint64_t RANK_5_MASK = 0xFF00000000ULL;
+
+    if (B.white_to_move) {
+        // White to move. EP target square is on rank 6.
+        // We check for white pawns on rank 5.
+        uint64_t white_pawns_on_rank_5 = B.bitboard[chess::WP] & RANK_5_MASK;
+        if (white_pawns_on_rank_5) {
+            // Check pawn to the left (e.g., c5 for d6)
+            if (ep_file > 0 && (white_pawns_on_rank_5 & (ONE << (B.en_passant_sq - 9)))) can_capture = true;
+            // Check pawn to the right (e.g., e5 for d6)
+            if (!can_capture && ep_file < 7 && (white_pawns_on_rank_5 & (ONE << (B.en_passant_sq - 7)))) can_capture = true;
+        }
+    } else {
+        // Black to move. EP target square is on rank 3.
+        // We check for black pawns on rank 4.
+        uint64_t black_pawns_on_rank_4 = B.bitboard[chess::BP] & RANK_4_MASK;
+        if (black_pawns_on_rank_4) {
+            // Check pawn to the left (e.g., d4 for e3)
+            if (ep_file > 0 && (black_pawns_on_rank_4 & (ONE << (B.en_passant_sq + 7)))) can_capture = true;
+            // Check pawn to the right (e.g., f4 for e3)
+            if (!can_capture && ep_file < 7 && (black_pawns_on_rank_4 & (ONE << (B.en_passant_sq + 9)))) can_capture = true;
+        }
+    }
+
+    return can_capture ? Zobrist::enPassantFile[ep_file] : 0ULL;
 }
 
 /**
@@ -264,9 +301,6 @@ uint64_t Zobrist::calculate_zobrist_hash(const Board& B)
 {
     uint64_t hash = 0;
     
-    // Assuming 1ULL is defined somewhere (like board.h)
-    const uint64_t ONE = 1ULL; 
-
     // --- 1. Pieces ---
     for(int p = chess::WP; p <= chess::BK; ++p) {
         if (p == 7 || p == 8) continue; 
@@ -280,42 +314,9 @@ uint64_t Zobrist::calculate_zobrist_hash(const Board& B)
         }
     }
 
-    // --- 2. En Passant (THE FIX) ---
-    if (B.en_passant_sq != chess::SQUARE_NONE) {
-        int ep_file = B.en_passant_sq % 8;
-        bool can_capture = false;
-        
-        // Define rank masks (assuming 0=Rank1, 7=Rank8)
-        const uint64_t RANK_4_MASK = 0xFF000000ULL;
-        const uint64_t RANK_5_MASK = 0xFF00000000ULL;
+    // --- 2. En Passant (only when a capture is possible) ---
+    hash ^= en_passant_key(B);
 
-        if (B.white_to_move) {
-            // White to move. EP target square is on rank 6.
-            // We check for white pawns on rank 5.
-            uint64_t white_pawns_on_rank_5 = B.bitboard[chess::WP] & RANK_5_MASK;
-            if (white_pawns_on_rank_5) {
-                // Check pawn to the left (e.g., c5 for d6)
-                if (ep_file > 0 && (white_pawns_on_rank_5 & (ONE << (B.en_passant_sq - 9)))) can_capture = true;
-                // Check pawn to the right (e.g., e5 for d6)
-                if (!can_capture && ep_file < 7 && (white_pawns_on_rank_5 & (ONE << (B.en_passant_sq - 7)))) can_capture = true;
-            }
-        } else {
-            // Black to move. EP target square is on rank 3.
-            // We check for black pawns on rank 4.
-            uint64_t black_pawns_on_rank_4 = B.bitboard[chess::BP] & RANK_4_MASK;
-            if (black_pawns_on_rank_4) {
-                // Check pawn to the left (e.g., d4 for e3)
-                if (ep_file > 0 && (black_pawns_on_rank_4 & (ONE << (B.en_passant_sq + 7)))) can_capture = true;
-                // Check pawn to the right (e.g., f4 for e3)
-                if (!can_capture && ep_file < 7 && (black_pawns_on_rank_4 & (ONE << (B.en_passant_sq + 9)))) can_capture = true;
-            }
-        }
-
-        if (can_capture) {
-            hash ^= Zobrist::enPassantFile[ep_file];
-        }
-    }
-    
     // --- 3. Castling ---
     if (B.castle_rights & chess::CastlingRights::WHITE_KINGSIDE) hash ^= Zobrist::castlingRights[0];
     if (B.castle_rights & chess::CastlingRights::WHITE_QUEENSIDE) hash ^= Zobrist::castlingRights[1];
@@ -2,7 +2,23 @@
 #include "engine/search.h"
 #include "engine/evaluate.h"
 
-eval::TaperedScore king_safety_score(const Board& b, chess::Color color) {
+// Every term is written once from the point of view of Us and instantiated for both sides.
+// White's terms are added and Black's subtracted, so the total is from White's point of view.
+template<chess::Color Us>
+struct Side {
+    static constexpr chess::Color Them = (Us == chess::WHITE) ? chess::BLACK : chess::WHITE;
+    static constexpr int Sign = (Us == chess::WHITE) ? 1 : -1;
+    static constexpr chess::Piece Pawn = chess::make_piece(Us, chess::PAWN);
+    static constexpr chess::Piece TheirPawn = chess::make_piece(Them, chess::PAWN);
+    static constexpr int Forward = (Us == chess::WHITE) ? 8 : -8;
+
+    // Piece-square tables are written for White, Black looks them up mirrored
+    static constexpr chess::Square relative(chess::Square sq) { return (Us == chess::WHITE) ? sq : util::flip(sq); }
+};
+
+template<chess::Color Us>
+eval::TaperedScore king_safety_score(const Board& b) {
+    constexpr chess::Color color = Us;
     eval::TaperedScore safety_score = {0, 0};
     chess::Square king_square = (color == chess::WHITE) ? b.white_king_sq : b.black_king_sq;
     int king_file = util::get_file(king_square);
@@ -10,54 +26,37 @@ eval::TaperedScore king_safety_score(const Board& b, chess::Color color) {
     // --- Part 1: Pawn Shield Evaluation (Corrected) ---
     for (int file_idx = king_file - 1; file_idx <= king_file + 1; ++file_idx) {
         if (file_idx < 0 || file_idx > 7) {
-            continue; 
+            continue;
         }
 
         uint64_t file_mask = chess::files[file_idx];
-        uint64_t friendly_pawns = file_mask & (color == chess::WHITE ? b.bitboard[chess::WP] : b.bitboard[chess::BP]);
+        uint64_t friendly_pawns = file_mask & b.bitboard[Side<Us>::Pawn];
 
         if (friendly_pawns == 0) {
             safety_score.mg += eval::eval_data.open_file_penalty.mg;
             safety_score.eg += eval::eval_data.open_file_penalty.eg;
-        } 
+        }
         else {
             chess::Square pawn_sq = (color == chess::WHITE) ? util::lsb(friendly_pawns) : util::msb(friendly_pawns);
 
             int pawn_rank = util::get_rank(pawn_sq);
-            int ideal_rank = (color == chess::WHITE) ? util::Rank2 : util::Rank7;
+            // Rank indices (0 = first rank): the shield belongs on the second rank
+            int ideal_rank = (color == chess::WHITE) ? 1 : 6;
             int rank_dist = std::abs(pawn_rank - ideal_rank);
 
-            if (rank_dist > 0 && rank_dist < eval::eval_data.pawn_shield_penalty.size()) {
+            if (rank_dist > 0 && rank_dist < (int)eval::eval_data.pawn_shield_penalty.size()) {
                 safety_score.mg += eval::eval_data.pawn_shield_penalty[rank_dist].mg;
                 safety_score.eg += eval::eval_data.pawn_shield_penalty[rank_dist].eg;
             }
         }
     }
 
-    // --- Part 2: Attacks on the King Zone (This part was already correct) ---
+    // --- Part 2: Attacks on the King Zone ---
+    // Every attacker counts once per square next to our king it hits, weighted by its type.
+    // The board's attack maps already count those hits.
     int attack_score = 0;
-    chess::Color enemy_color = (color == chess::WHITE) ? chess::BLACK : chess::WHITE;
-    bool by_white = (enemy_color == chess::WHITE);
-    int king_rank = util::get_rank(king_square); // king_file is already defined above
-
-    for (int df = -1; df <= 1; ++df) {
-        for (int dr = -1; dr <= 1; ++dr) {
-            if (df == 0 && dr == 0) continue;
-
-            int target_file = king_file + df;
-            int target_rank = king_rank + dr;
-
-            if (target_file >= 0 && target_file <= 7 && target_rank >= 0 && target_rank <= 7) {
-                chess::Square target_sq = chess::Square(target_rank * 8 + target_file);
-                uint64_t attackers = b.attackers_to(target_sq, by_white);
-
-                while (attackers) {
-                    chess::Square attacker_sq = util::pop_lsb(attackers);
-                    chess::PieceType pt = chess::type_of(b.piece_on_sq(attacker_sq));
-                    attack_score += eval::eval_data.king_attack_weights[pt];
-                }
-            }
-        }
+    for (int pt = chess::PAWN; pt <= chess::KING; ++pt) {
+        attack_score += eval::eval_data.king_attack_weights[pt] * b.king_zone_attacks(Side<Us>::Them, (chess::PieceType)pt);
     }
 
     int final_attack_index = std::min(attack_score, (int)eval::eval_data.king_safety_table.size() - 1);
@@ -67,10 +66,11 @@ eval::TaperedScore king_safety_score(const Board& b, chess::Color color) {
     return safety_score;
 }
 
-eval::TaperedScore king_activity_score(const Board& b, chess::Color color) {
+template<chess::Color Us>
+eval::TaperedScore king_activity_score(const Board& b) {
     eval::TaperedScore activity_score = {0, 0};
-    const chess::Square king_square = (color == chess::WHITE) ? b.white_king_sq : b.black_king_sq;
-    const chess::Square opponent_king_square = (color == chess::WHITE) ? b.black_king_sq : b.white_king_sq;
+    const chess::Square king_square = (Us == chess::WHITE) ? b.white_king_sq : b.black_king_sq;
+    const chess::Square opponent_king_square = (Us == chess::WHITE) ? b.black_king_sq : b.white_king_sq;
 
     const int king_rank = util::get_rank(king_square);
     const int king_file = util::get_file(king_square);
@@ -80,7 +80,7 @@ eval::TaperedScore king_activity_score(const Board& b, chess::Color color) {
     const int king_dist_to_center_rank = std::max(3 - king_rank, king_rank - 4);
     const int king_dist_to_center_file = std::max(3 - king_file, king_file - 4);
     const int king_dist_from_center = king_dist_to_center_file + king_dist_to_center_rank;
-    
+
     // Distance of King from Center
     activity_score.eg += king_dist_from_center * eval::eval_data.opponent_king_distance_opponent_king_penalty.eg;
 
@@ -94,391 +94,168 @@ eval::TaperedScore king_activity_score(const Board& b, chess::Color color) {
     return activity_score;
 }
 
+template<chess::Color Us>
 void pawn_evaluation(const Board& b, int& mg_score, int& eg_score) {
-    
-    // 1. White Pawns
-    uint64_t white_pawns = b.bitboard[chess::WP];
-    while (white_pawns) {
-        chess::Square sq = util::pop_lsb(white_pawns);
-        mg_score += eval::eval_data.material_values[chess::PAWN].mg;
-        eg_score += eval::eval_data.material_values[chess::PAWN].eg;
-        
-        mg_score += eval::eval_data.psts[chess::PAWN][sq].mg;
-        eg_score += eval::eval_data.psts[chess::PAWN][sq].eg;
-        
-        // Passed Pawn Bonus
-        uint64_t passing_mask = eval::eval_data.passed_pawn_masks_white[sq];
-        uint64_t enemy_pawns = b.bitboard[chess::BP] & passing_mask;
-        if ( !enemy_pawns ) {
-            mg_score += eval::eval_data.passed_pawn_bonus[util::get_rank(sq)].mg;
-            eg_score += eval::eval_data.passed_pawn_bonus[util::get_rank(sq)].eg;
-        }
-        
-        // Connected Pawn Bonus
-        uint64_t connecting_square = chess::PawnAttacks[chess::BLACK][sq];
-        if (connecting_square & b.bitboard[chess::WP]) {
-            mg_score += eval::eval_data.connected_pawn_bonus.mg;
-            eg_score += eval::eval_data.connected_pawn_bonus.eg;
-        }
+    using S = Side<Us>;
+    const uint64_t our_pawns = b.bitboard[S::Pawn];
+    const uint64_t their_pawns = b.bitboard[S::TheirPawn];
+    const auto& passed_pawn_masks = (Us == chess::WHITE) ? eval::eval_data.passed_pawn_masks_white : eval::eval_data.passed_pawn_masks_black;
 
-        // Backward Pawn Penalty
-        uint64_t backward_mask = chess::passed_pawn_masks_black[sq];
-        uint64_t friendly_pawns = b.bitboard[chess::WP] & backward_mask;
-        if ( !friendly_pawns ){
-            uint64_t next_square_bitboard = util::shift_board(util::create_bitboard_from_square(sq), chess::NORTH);
-            int next_square = util::lsb(next_square_bitboard);
-            uint64_t next_square_attacking_mask = chess::PawnAttacks[chess::WHITE][next_square];
+    uint64_t pawns = our_pawns;
+    while (pawns) {
+        chess::Square sq = util::pop_lsb(pawns);
+        const chess::Square pst_sq = S::relative(sq);
 
-            if ( next_square_attacking_mask & b.bitboard[chess::BP] ){
-                mg_score -= eval::eval_data.backward_pawn_penalty.mg;
-                eg_score -= eval::eval_data.backward_pawn_penalty.eg;
-            }
-        }
-        
-        // Isolated Pawn Penalty
-        int file = util::get_file(sq);
-        uint64_t adjacent_files = eval::eval_data.adjacent_files_masks[file];
-        if (!(b.bitboard[chess::WP] & adjacent_files)) {
-            mg_score += eval::eval_data.isolated_pawn_penalty.mg;
-            eg_score += eval::eval_data.isolated_pawn_penalty.eg;
-        }
-    }
-    
-    // 2. Black Pawns
-    uint64_t black_pawns = b.bitboard[chess::BP];
-    while (black_pawns) {
-        chess::Square sq = util::pop_lsb(black_pawns);
-        mg_score -= eval::eval_data.material_values[chess::PAWN].mg;
-        eg_score -= eval::eval_data.material_values[chess::PAWN].eg;
-        
-        chess::Square pst_sq = util::flip(sq);
-        mg_score -= eval::eval_data.psts[chess::PAWN][pst_sq].mg;
-        eg_score -= eval::eval_data.psts[chess::PAWN][pst_sq].eg;
-        
         // Passed Pawn Bonus
-        uint64_t passing_mask = eval::eval_data.passed_pawn_masks_black[sq];
-        uint64_t enemy_pawns = b.bitboard[chess::WP] & passing_mask;
-        if ( !enemy_pawns ) {
-            mg_score -= eval::eval_data.passed_pawn_bonus[util::get_rank(pst_sq)].mg;
-            eg_score -= eval::eval_data.passed_pawn_bonus[util::get_rank(pst_sq)].eg;
+        if (!(their_pawns & passed_pawn_masks[sq])) {
+            mg_score += S::Sign * eval::eval_data.passed_pawn_bonus[util::get_rank(pst_sq)].mg;
+            eg_score += S::Sign * eval::eval_data.passed_pawn_bonus[util::get_rank(pst_sq)].eg;
         }
-        
+
         // Connected Pawn Bonus
-        uint64_t connecting_square = chess::PawnAttacks[chess::WHITE][sq];
-        if ( connecting_square & b.bitboard[chess::BP] ) {
-            mg_score -= eval::eval_data.connected_pawn_bonus.mg;
-            eg_score -= eval::eval_data.connected_pawn_bonus.eg;
+        uint64_t connecting_square = chess::PawnAttacks[S::Them][sq];
+        if (connecting_square & our_pawns) {
+            mg_score += S::Sign * eval::eval_data.connected_pawn_bonus.mg;
+            eg_score += S::Sign * eval::eval_data.connected_pawn_bonus.eg;
         }
 
         // Backward Pawn Penalty
         uint64_t backward_mask = chess::passed_pawn_masks_black[sq];
-        uint64_t friendly_pawns = b.bitboard[chess::BP] & backward_mask;
+        uint64_t friendly_pawns = our_pawns & backward_mask;
         if ( !friendly_pawns ){
-            uint64_t next_square_bitboard = util::shift_board(util::create_bitboard_from_square(sq), chess::SOUTH);
-            int next_square = util::lsb(next_square_bitboard);
-            uint64_t next_square_attacking_mask = chess::PawnAttacks[chess::BLACK][next_square];
+            uint64_t next_square_attacking_mask = chess::PawnAttacks[Us][sq + S::Forward];
 
-            if ( next_square_attacking_mask & b.bitboard[chess::WP] ){
-                mg_score += eval::eval_data.backward_pawn_penalty.mg;
-                eg_score += eval::eval_data.backward_pawn_penalty.eg;
+            if ( next_square_attacking_mask & their_pawns ){
+                mg_score -= S::Sign * eval::eval_data.backward_pawn_penalty.mg;
+                eg_score -= S::Sign * eval::eval_data.backward_pawn_penalty.eg;
             }
         }
-        
+
         // Isolated Pawn Penalty
         int file = util::get_file(sq);
         uint64_t adjacent_files = eval::eval_data.adjacent_files_masks[file];
-        if (!(b.bitboard[chess::BP] & adjacent_files)) {
-            mg_score -= eval::eval_data.isolated_pawn_penalty.mg;
-            eg_score -= eval::eval_data.isolated_pawn_penalty.eg;
+        if (!(our_pawns & adjacent_files)) {
+            mg_score += S::Sign * eval::eval_data.isolated_pawn_penalty.mg;
+            eg_score += S::Sign * eval::eval_data.isolated_pawn_penalty.eg;
         }
-    }    
-    
+    }
+
     // Doubled Pawns Penalty
     for (auto file : chess::files) {
-        uint64_t pawns_on_file_white = b.bitboard[chess::WP] & file;
-        if (util::count_bits(pawns_on_file_white) > 1) {
-            mg_score += eval::eval_data.doubled_pawn_penalty.mg * util::count_bits(pawns_on_file_white);
-            eg_score += eval::eval_data.doubled_pawn_penalty.eg * util::count_bits(pawns_on_file_white);
-        }
-        uint64_t pawns_on_file_black = b.bitboard[chess::BP] & file;
-        if (util::count_bits(pawns_on_file_black) > 1) {
-            mg_score -= eval::eval_data.doubled_pawn_penalty.mg * util::count_bits(pawns_on_file_black);
-            eg_score -= eval::eval_data.doubled_pawn_penalty.eg * util::count_bits(pawns_on_file_black);
+        uint64_t pawns_on_file = our_pawns & file;
+        if (util::count_bits(pawns_on_file) > 1) {
+            mg_score += S::Sign * eval::eval_data.doubled_pawn_penalty.mg * util::count_bits(pawns_on_file);
+            eg_score += S::Sign * eval::eval_data.doubled_pawn_penalty.eg * util::count_bits(pawns_on_file);
         }
     }
 }
 
-void knight_evaluation(const Board& b, int& mg_score, int& eg_score, int& game_phase) {
-    // 1. White Knights
-    uint64_t white_knights = b.bitboard[chess::WN];
-    while (white_knights) {
-        chess::Square sq = util::pop_lsb(white_knights);
-        mg_score += eval::eval_data.material_values[chess::KNIGHT].mg;
-        eg_score += eval::eval_data.material_values[chess::KNIGHT].eg;
-        
-        mg_score += eval::eval_data.psts[chess::KNIGHT][sq].mg;
-        eg_score += eval::eval_data.psts[chess::KNIGHT][sq].eg;
-
-        game_phase += eval::eval_data.phase_values[chess::KNIGHT]; 
-
-        uint64_t knight_outpost_square = chess::PawnAttacks[chess::BLACK][sq];
-        if (knight_outpost_square & b.bitboard[chess::WP]){
-            mg_score += eval::eval_data.knight_outpost_bonus.mg;
-            eg_score += eval::eval_data.knight_outpost_bonus.eg;
-        }
-    }
-    
-    // 2. Black Knights
-    uint64_t black_knights = b.bitboard[chess::BN];
-    while (black_knights) {
-        chess::Square sq = util::pop_lsb(black_knights);
-        mg_score -= eval::eval_data.material_values[chess::KNIGHT].mg;
-        eg_score -= eval::eval_data.material_values[chess::KNIGHT].eg;
-
-        int pst_sq = util::flip(sq);
-        mg_score -= eval::eval_data.psts[chess::KNIGHT][pst_sq].mg;
-        eg_score -= eval::eval_data.psts[chess::KNIGHT][pst_sq].eg;
-
-        game_phase += eval::eval_data.phase_values[chess::KNIGHT]; 
+template<chess::Color Us>
+void knight_evaluation(const Board& b, int& mg_score, int& eg_score) {
+    using S = Side<Us>;
+    uint64_t knights = b.bitboard[chess::make_piece(Us, chess::KNIGHT)];
+    while (knights) {
+        chess::Square sq = util::pop_lsb(knights);
 
         // knight outpost
-        uint64_t knight_outpost_square = chess::PawnAttacks[chess::WHITE][sq];
-        if (knight_outpost_square & b.bitboard[chess::BP]){
-            mg_score -= eval::eval_data.knight_outpost_bonus.mg;
-            eg_score -= eval::eval_data.knight_outpost_bonus.eg;
+        uint64_t knight_outpost_square = chess::PawnAttacks[S::Them][sq];
+        if (knight_outpost_square & b.bitboard[S::Pawn]){
+            mg_score += S::Sign * eval::eval_data.knight_outpost_bonus.mg;
+            eg_score += S::Sign * eval::eval_data.knight_outpost_bonus.eg;
         }
     }
 }
 
-void bishop_evaluation(const Board& b, int& mg_score, int& eg_score, int& game_phase) {
-    // 1. White Bishops
-    uint64_t white_bishops = b.bitboard[chess::WB];
-    while (white_bishops) {
-        chess::Square sq = util::pop_lsb(white_bishops);
-        mg_score += eval::eval_data.material_values[chess::BISHOP].mg;
-        eg_score += eval::eval_data.material_values[chess::BISHOP].eg;
-        
-        mg_score += eval::eval_data.psts[chess::BISHOP][sq].mg;
-        eg_score += eval::eval_data.psts[chess::BISHOP][sq].eg;
-
-        game_phase += eval::eval_data.phase_values[chess::BISHOP]; 
-    }
-    
-    // 2. Black Bishops
-    uint64_t black_bishops = b.bitboard[chess::BB];
-    while (black_bishops) {
-        chess::Square sq = util::pop_lsb(black_bishops);
-        mg_score -= eval::eval_data.material_values[chess::BISHOP].mg;
-        eg_score -= eval::eval_data.material_values[chess::BISHOP].eg;
-
-        int pst_sq = util::flip(sq);
-        mg_score -= eval::eval_data.psts[chess::BISHOP][pst_sq].mg;
-        eg_score -= eval::eval_data.psts[chess::BISHOP][pst_sq].eg;
-
-        game_phase += eval::eval_data.phase_values[chess::BISHOP]; 
-    }
-
+template<chess::Color Us>
+void bishop_evaluation(const Board& b, int& mg_score, int& eg_score) {
+    using S = Side<Us>;
     // Bishop Pair Bonus
-    int white_bishops_count = util::count_bits(b.bitboard[chess::WB]);
-    int black_bishops_count = util::count_bits(b.bitboard[chess::BB]);
-    
-    if (white_bishops_count >= 2) {
-        mg_score += eval::eval_data.bishop_pair_bonus.mg;
-        eg_score += eval::eval_data.bishop_pair_bonus.eg;
-    }
-    if (black_bishops_count >= 2) {
-        mg_score -= eval::eval_data.bishop_pair_bonus.mg;
-        eg_score -= eval::eval_data.bishop_pair_bonus.eg;
+    if (util::count_bits(b.bitboard[chess::make_piece(Us, chess::BISHOP)]) >= 2) {
+        mg_score += S::Sign * eval::eval_data.bishop_pair_bonus.mg;
+        eg_score += S::Sign * eval::eval_data.bishop_pair_bonus.eg;
     }
 }
 
-void rook_evaluation(const Board& b, int& mg_score, int& eg_score, int& game_phase) {
-    // 1. White Rooks
-    uint64_t white_rooks = b.bitboard[chess::WR];
-    while (white_rooks) {
-        chess::Square sq = util::pop_lsb(white_rooks);
-        // Material Score
-        mg_score += eval::eval_data.material_values[chess::ROOK].mg;
-        eg_score += eval::eval_data.material_values[chess::ROOK].eg;
-        
-        // PST
-        mg_score += eval::eval_data.psts[chess::ROOK][sq].mg;
-        eg_score += eval::eval_data.psts[chess::ROOK][sq].eg;
-
-        // Game Phase Calculation
-        game_phase += eval::eval_data.phase_values[chess::ROOK]; 
+template<chess::Color Us>
+void rook_evaluation(const Board& b, int& mg_score, int& eg_score) {
+    using S = Side<Us>;
+    uint64_t rooks = b.bitboard[chess::make_piece(Us, chess::ROOK)];
+    while (rooks) {
+        chess::Square sq = util::pop_lsb(rooks);
+        const chess::Square pst_sq = S::relative(sq);
 
         // 7th Rank Bonus
-        int rook_rank = util::get_rank(sq);
-        if (rook_rank == 6){
-            mg_score += eval::eval_data.rook_on_7th_bonus.mg;
-            eg_score += eval::eval_data.rook_on_7th_bonus.eg;
+        if (util::get_rank(pst_sq) == 6){
+            mg_score += S::Sign * eval::eval_data.rook_on_7th_bonus.mg;
+            eg_score += S::Sign * eval::eval_data.rook_on_7th_bonus.eg;
         }
 
         // Open and Semi Open files
         int rook_file = util::get_file(sq);
         uint64_t file_mask = chess::files[rook_file];
-        bool no_friendly_pawns = (file_mask & b.bitboard[chess::WP]) == 0;
-        bool no_enemy_pawns = (file_mask & b.bitboard[chess::BP]) == 0;   
+        bool no_friendly_pawns = (file_mask & b.bitboard[S::Pawn]) == 0;
+        bool no_enemy_pawns = (file_mask & b.bitboard[S::TheirPawn]) == 0;
 
         if (no_friendly_pawns) {
             if (no_enemy_pawns) {
                 // Open File
-                mg_score += eval::eval_data.rook_on_open_file_bonus.mg;
-                eg_score += eval::eval_data.rook_on_open_file_bonus.eg;
-            } 
-            else {
-                // Semi-Open File
-                mg_score += eval::eval_data.rook_on_semi_open_file_bonus.mg;
-                eg_score += eval::eval_data.rook_on_semi_open_file_bonus.eg;
+                mg_score += S::Sign * eval::eval_data.rook_on_open_file_bonus.mg;
+                eg_score += S::Sign * eval::eval_data.rook_on_open_file_bonus.eg;
             }
-        }  
-        
-        // Connected Rooks
-        uint64_t rook_attack_mask = chess::get_orthogonal_slider_attacks(sq, b.occupied);
-        if (rook_attack_mask & white_rooks){
-            mg_score += eval::eval_data.rook_connected_bonus.mg;
-            eg_score += eval::eval_data.rook_connected_bonus.eg;
-        }
-    }
-    
-    // 2. Black Rooks
-    uint64_t black_rooks = b.bitboard[chess::BR];
-    while (black_rooks) {
-        // Materail Score
-        chess::Square sq = util::pop_lsb(black_rooks);
-        mg_score -= eval::eval_data.material_values[chess::ROOK].mg;
-        eg_score -= eval::eval_data.material_values[chess::ROOK].eg;
-
-        // Positional Score
-        int pst_sq = util::flip(sq);
-        mg_score -= eval::eval_data.psts[chess::ROOK][pst_sq].mg;
-        eg_score -= eval::eval_data.psts[chess::ROOK][pst_sq].eg;
-
-        // Game Phase calculation
-        game_phase += eval::eval_data.phase_values[chess::ROOK]; 
-
-        // Rook on 7th Rank
-        int rook_rank = util::get_rank(sq);
-        if (rook_rank == 1){
-            mg_score -= eval::eval_data.rook_on_7th_bonus.mg;
-            eg_score -= eval::eval_data.rook_on_7th_bonus.eg;
-        }
-        
-        // Open and Semi Open files
-        int rook_file = util::get_file(sq);
-        uint64_t file_mask = chess::files[rook_file];
-        bool no_friendly_pawns = (file_mask & b.bitboard[chess::BP]) == 0;
-        bool no_enemy_pawns = (file_mask & b.bitboard[chess::WP]) == 0;   
-
-        if (no_friendly_pawns) {
-            if (no_enemy_pawns) {
-                // Open File
-                mg_score -= eval::eval_data.rook_on_open_file_bonus.mg;
-                eg_score -= eval::eval_data.rook_on_open_file_bonus.eg;
-            } 
             else {
                 // Semi-Open File
-                mg_score -= eval::eval_data.rook_on_semi_open_file_bonus.mg;
-                eg_score -= eval::eval_data.rook_on_semi_open_file_bonus.eg;
+                mg_score += S::Sign * eval::eval_data.rook_on_semi_open_file_bonus.mg;
+                eg_score += S::Sign * eval::eval_data.rook_on_semi_open_file_bonus.eg;
             }
         }
 
         // Connected Rooks
         uint64_t rook_attack_mask = chess::get_orthogonal_slider_attacks(sq, b.occupied);
-        if (rook_attack_mask & black_rooks){
-            mg_score -= eval::eval_data.rook_connected_bonus.mg;
-            eg_score -= eval::eval_data.rook_connected_bonus.eg;
+        if (rook_attack_mask & rooks){
+            mg_score += S::Sign * eval::eval_data.rook_connected_bonus.mg;
+            eg_score += S::Sign * eval::eval_data.rook_connected_bonus.eg;
         }
     }
 }
 
-void queen_evaluation(const Board& b, int& mg_score, int& eg_score, int& game_phase) {
-    // 1. White Queens
-    uint64_t white_queens = b.bitboard[chess::WQ];
-    while (white_queens) {
-        chess::Square sq = util::pop_lsb(white_queens);
-        mg_score += eval::eval_data.material_values[chess::QUEEN].mg;
-        eg_score += eval::eval_data.material_values[chess::QUEEN].eg;
-        
-        mg_score += eval::eval_data.psts[chess::QUEEN][sq].mg;
-        eg_score += eval::eval_data.psts[chess::QUEEN][sq].eg;
-
-        game_phase += eval::eval_data.phase_values[chess::QUEEN];
-    }
-    
-    // 2. Black Queens
-    uint64_t black_queens = b.bitboard[chess::BQ];
-    while (black_queens) {
-        chess::Square sq = util::pop_lsb(black_queens);
-        mg_score -= eval::eval_data.material_values[chess::QUEEN].mg;
-        eg_score -= eval::eval_data.material_values[chess::QUEEN].eg;
-
-        int pst_sq = util::flip(sq);
-        mg_score -= eval::eval_data.psts[chess::QUEEN][pst_sq].mg;
-        eg_score -= eval::eval_data.psts[chess::QUEEN][pst_sq].eg;
-
-        game_phase += eval::eval_data.phase_values[chess::QUEEN];
-    }
-}
-
+template<chess::Color Us>
 void king_evaluation(const Board& b, int& mg_score, int& eg_score) {
-    // 1. White King
-    uint64_t white_king = b.bitboard[chess::WK];
-    if (white_king) {
-        chess::Square sq = util::pop_lsb(white_king);
-
-        mg_score += eval::eval_data.psts[chess::KING][sq].mg;
-        eg_score += eval::eval_data.psts[chess::KING][sq].eg;
-    }
-    
-    // 2. Black King
-    uint64_t black_king = b.bitboard[chess::BK];
-    if (black_king) {
-        chess::Square sq = util::pop_lsb(black_king);
-
-        int pst_sq = util::flip(sq);
-        mg_score -= eval::eval_data.psts[chess::KING][pst_sq].mg;
-        eg_score -= eval::eval_data.psts[chess::KING][pst_sq].eg;
-    }
+    using S = Side<Us>;
 
     // King Safty
-    eval::TaperedScore white_king_safety = king_safety_score(b, chess::Color::WHITE);
-    eval::TaperedScore black_king_safety = king_safety_score(b, chess::Color::BLACK);
-    mg_score += white_king_safety.mg - black_king_safety.mg;
-    eg_score += white_king_safety.eg - black_king_safety.eg;
+    eval::TaperedScore king_safety = king_safety_score<Us>(b);
+    mg_score += S::Sign * king_safety.mg;
+    eg_score += S::Sign * king_safety.eg;
+
+    // King Activity
+    eval::TaperedScore king_activity = king_activity_score<Us>(b);
+    mg_score += S::Sign * king_activity.mg;
+    eg_score += S::Sign * king_activity.eg;
+}
 
-    // King Safty
-    eval::TaperedScore white_king_activity = king_activity_score(b, chess::Color::WHITE);
-    eval::TaperedScore black_king_activity = king_activity_score(b, chess::Color::BLACK);
-    mg_score += white_king_activity.mg - black_king_activity.mg;
-    eg_score += white_king_activity.eg - black_king_activity.eg;
+template<chess::Color Us>
+void evaluate_side(const Board& b, int& mg_score, int& eg_score) {
+    pawn_evaluation<Us>(b, mg_score, eg_score);
+    knight_evaluation<Us>(b, mg_score, eg_score);
+    bishop_evaluation<Us>(b, mg_score, eg_score);
+    rook_evaluation<Us>(b, mg_score, eg_score);
+    king_evaluation<Us>(b, mg_score, eg_score);
 }
 
 int Search::evaluate(const Board& b) {
-    int mg_score = 0;
-    int eg_score = 0;
-    int game_phase = 0;
-
-    pawn_evaluation(b, mg_score, eg_score);
-    // std::cout << "Pawn Eval: " << mg_score << " (MG), " << eg_score << " (EG)" << std::endl;
-    knight_evaluation(b, mg_score, eg_score, game_phase);
-    // std::cout << "Knight Eval: " << mg_score << " (MG), " << eg_score << " (EG)" << std::endl;
-    bishop_evaluation(b, mg_score, eg_score, game_phase);
-    // std::cout << "Bishop Eval: " << mg_score << " (MG), " << eg_score << " (EG)" << std::endl;
-    rook_evaluation(b, mg_score, eg_score, game_phase);
-    // std::cout << "Rook Eval: " << mg_score << " (MG), " << eg_score << " (EG)" << std::endl;
-    queen_evaluation(b, mg_score, eg_score, game_phase);
-    // std::cout << "Queen Eval: " << mg_score << " (MG), " << eg_score << " (EG)" << std::endl;
-    king_evaluation(b, mg_score, eg_score);
-    // std::cout << "King Eval: " << mg_score << " (MG), " << eg_score << " (EG)" << std::endl;
+    // Material, piece-square values and phase are kept up to date by make_move
+    int mg_score = psqt::mg_value(b.psq);
+    int eg_score = psqt::eg_value(b.psq);
+
+    evaluate_side<chess::WHITE>(b, mg_score, eg_score);
+    evaluate_side<chess::BLACK>(b, mg_score, eg_score);
 
     // Clamp game phase to valid range
-    game_phase = std::max(0, std::min(game_phase, eval::TOTAL_PHASE));
+    const int game_phase = std::max(0, std::min(b.game_phase, eval::TOTAL_PHASE));
 
     int final_score = (mg_score * game_phase + eg_score * (eval::TOTAL_PHASE - game_phase)) / eval::TOTAL_PHASE;
 
     // return final_score;
     return b.white_to_move ? final_score : -final_score;
 
-}
\ No newline at end of file
+}
@@ -1,75 +1,167 @@
 #include "engine/move_orderer.h"
 #include "engine/search.h" 
-#include "engine/transposition.h"
 
 const int piece_vals[7] = {0, 100, 320, 330, 500, 900, 0}; //null, P, N, B, R, Q, K
-const int HASH_MOVE_BONUS = 20000;
-const int CAPTURE_BONUS = 5000;
-const int KILLER_BONUS = 900;
+const int promoBonus[7] = {0, 0, 200, 100, 400, 1000, 0};  //Null, P, N, B, R, Q, K
 
-MoveOrderer::MoveOrderer(const Board& B, int ply, Search& s, bool capturesOnly)
+MoveOrderer::MoveOrderer(const Board& B, const SearchStack* ss, Search& s, const chess::Move& tt_move, bool capturesOnly)
+    : B(B), s(s), captures_only(capturesOnly)
 {
-    chess::Move best_move{};
-    TTEntry entry{};
-    if(s.TT.probe(B.zobrist_key, entry))
-    {
-        best_move = entry.best_move;
+    // Qsearch in check has to look at every evasion
+    if (capturesOnly && B.checks) stage = EVASION_TT_MOVE;
+
+    // Otherwise the hash move only counts in qsearch if it is one of the moves qsearch would search
+    const bool tt_usable = !capturesOnly || B.checks || (tt_move.flags() & (chess::FLAG_CAPTURE | chess::FLAG_EP));
+    this->tt_move = (tt_usable && MoveGen::is_legal(B, tt_move)) ? tt_move : chess::Move{};
+
+    if (ss) {
+        killers[0] = ss->killers[0];
+        killers[1] = ss->killers[1];
     }
+}
+
+bool MoveOrderer::is_special(const chess::Move& m) const {
+    return m.m == tt_move.m || (!captures_only && (m.m == killers[0].m || m.m == killers[1].m));
+}
 
-    std::vector<chess::Move> moveList;
-    MoveGen::init(B, moveList, capturesOnly);
-    score_moves(B,ply,s,moveList,best_move);
+void MoveOrderer::score_captures() {
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const chess::Move& v = moves[i];
+        chess::PieceType victim = (v.flags() == chess::FLAG_EP) ? chess::PAWN : chess::type_of(B.board_array[v.to()]);
+        chess::PieceType attacker = chess::type_of(B.board_array[v.from()]);
+
+        scores[i] = piece_vals[victim] - piece_vals[attacker];
+        if (v.flags() == chess::FLAG_CAPTURE_PROMO) {
+            scores[i] += promoBonus[chess::type_of((chess::Piece)v.promo())];
+        }
+    }
+}
 
-    std::sort(scored_moves.begin(), scored_moves.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+void MoveOrderer::score_quiets() {
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const chess::Move& v = moves[i];
+        if (v.flags() == chess::FLAG_PROMO) {
+            scores[i] = MAX_HISTORY + promoBonus[chess::type_of((chess::Piece)v.promo())];
+        } else {
+            scores[i] = s.history_scores[B.board_array[v.from()]][v.to()];
+        }
+    }
 }
 
-void MoveOrderer::score_moves(const Board& B, int ply, Search& s, std::vector<chess::Move>& moveList, const chess::Move& best_move){
-    for(auto& v : moveList)
-    {
-        int score{};
-        if(v.m == best_move.m)
-        {
-            score += HASH_MOVE_BONUS;
+// Captures of the checker first, then the quiet evasions by history
+void MoveOrderer::score_evasions() {
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const chess::Move& v = moves[i];
+        if (v.flags() & (chess::FLAG_CAPTURE | chess::FLAG_EP)) {
+            chess::PieceType victim = (v.flags() & chess::FLAG_EP) ? chess::PAWN : chess::type_of(B.board_array[v.to()]);
+            scores[i] = 2 * MAX_HISTORY + piece_vals[victim] - piece_vals[chess::type_of(B.board_array[v.from()])];
+        } else {
+            scores[i] = s.history_scores[B.board_array[v.from()]][v.to()];
         }
-        else if(v.flags() == (chess::FLAG_PROMO) || v.flags() == (chess::FLAG_CAPTURE_PROMO))
-        {
-            static const int promoBonus[] = {0, 0, 5200, 5100, 5400, 6000, 0};  //Null, P, N, B, R, Q, K
-            chess::PieceType promotedPieceType = chess::type_of((chess::Piece)v.promo());
+    }
+}
+
+// Swaps the best remaining move of the current stage to the front and returns it
+chess::Move MoveOrderer::select_best() {
+    if (current_move >= moves.size()) return {};
 
-            score += promoBonus[promotedPieceType];
+    size_t best = current_move;
+    for (size_t i = current_move + 1; i < moves.size(); ++i) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    std::swap(moves[best], moves[current_move]);
+    std::swap(scores[best], scores[current_move]);
+    return moves[current_move++];
+}
+
+chess::Move MoveOrderer::get_next_move() {
+    chess::Move m;
 
-            if(v.flags() == chess::FLAG_CAPTURE_PROMO)
-            {
-                chess::PieceType victim = chess::type_of(B.board_array[v.to()]);
-                chess::PieceType attacker = chess::type_of(B.board_array[v.from()]);
+    switch (stage) {
+    case TT_MOVE:
+        stage = GEN_CAPTURES;
+        if (!tt_move.is_null()) return tt_move;
+        [[fallthrough]];
 
-                score += CAPTURE_BONUS + (piece_vals[victim] - piece_vals[attacker]);
+    case GEN_CAPTURES:
+        MoveGen::generate<MoveGen::CAPTURES>(B, moves);
+        score_captures();
+        current_move = 0;
+        stage = GOOD_CAPTURES;
+        [[fallthrough]];
+
+    case GOOD_CAPTURES:
+        while (!(m = select_best()).is_null()) {
+            if (m.m == tt_move.m) continue;
+            // Captures that lose material wait until after the quiet moves. Qsearch prunes them itself.
+            if (!captures_only && !B.see_ge(m, 0)) {
+                bad_captures.push_back(m);
+                continue;
             }
+            return m;
+        }
+        if (captures_only) {
+            stage = DONE;
+            return {};
         }
-        else if(v.flags() == chess::FLAG_CAPTURE || v.flags() == chess::FLAG_EP)
-        {
-            chess::PieceType victim = (v.flags() == chess::FLAG_EP) ? chess::PAWN : chess::type_of(B.board_array[v.to()]);
-            chess::PieceType attacker = chess::type_of(B.board_array[v.from()]);
+        stage = KILLER_1;
+        [[fallthrough]];
 
-            score += CAPTURE_BONUS + (piece_vals[victim] - piece_vals[attacker]);
+    case KILLER_1:
+        stage = KILLER_2;
+        if (killers[0].m != tt_move.m && MoveGen::is_legal(B, killers[0]) && !(killers[0].flags() & chess::FLAG_CAPTURE)) {
+            return killers[0];
         }
-        else{
-            if((s.killer_moves[ply][0].m == v.m) || (s.killer_moves[ply][1].m == v.m))
-            {
-                score += KILLER_BONUS;
-            }
-            else{
-                // score += s.history_scores[B.board_array[v.from()]][v.to()];
-            }
+        [[fallthrough]];
+
+    case KILLER_2:
+        stage = GEN_QUIETS;
+        if (killers[1].m != tt_move.m && killers[1].m != killers[0].m && MoveGen::is_legal(B, killers[1]) &&
+            !(killers[1].flags() & chess::FLAG_CAPTURE)) {
+            return killers[1];
         }
-        scored_moves.push_back({score, v});
-    }
-}
+        [[fallthrough]];
 
-chess::Move MoveOrderer::get_next_move() {
-    if (current_move < scored_moves.size()) {
-        return scored_moves[current_move++].second;
+    case GEN_QUIETS:
+        moves.clear();
+        MoveGen::generate<MoveGen::QUIETS>(B, moves);
+        score_quiets();
+        current_move = 0;
+        stage = QUIETS;
+        [[fallthrough]];
+
+    case QUIETS:
+        while (!(m = select_best()).is_null()) {
+            if (!is_special(m)) return m;
+        }
+        stage = BAD_CAPTURES;
+        [[fallthrough]];
+
+    case BAD_CAPTURES:
+        if (current_bad_capture < bad_captures.size()) return bad_captures[current_bad_capture++];
+        stage = DONE;
+        return {};
+
+    case EVASION_TT_MOVE:
+        stage = GEN_EVASIONS;
+        if (!tt_move.is_null()) return tt_move;
+        [[fallthrough]];
+
+    case GEN_EVASIONS:
+        MoveGen::generate<MoveGen::EVASIONS>(B, moves);
+        score_evasions();
+        current_move = 0;
+        stage = EVASIONS;
+        [[fallthrough]];
+
+    case EVASIONS:
+        while (!(m = select_best()).is_null()) {
+            if (m.m != tt_move.m) return m;
+        }
+        stage = DONE;
+        [[fallthrough]];
+
+    default:
+        return {};
     }
-    return {}; // Return a null move when done
 }
-
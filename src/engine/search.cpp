@@ -4,134 +4,185 @@
 #include "utils/threadpool.h"
 #include <vector>
 #include <algorithm>
+#include <string>
+#include <cstring>
+#include <cmath>
+
+Search::Search(size_t s): nodes_searched(0), TT(s), stopSearch(false), pool(std::max(1u, std::thread::hardware_concurrency()))
+{
+    for (int depth = 0; depth < 64; ++depth) {
+        for (int move_number = 0; move_number < 64; ++move_number) {
+            lmr_reductions[depth][move_number] = (depth == 0 || move_number == 0) ? 0
+                : (int)(0.75 + std::log(depth) * std::log(move_number) / 2.25);
+        }
+    }
+}
+
+void Search::clear() {
+    TT.clear();
+    stack_generation++;
+    std::memset(pv_table, 0, sizeof(pv_table));
+    std::memset(history_scores, 0, sizeof(history_scores));
+}
 
-Search::Search(size_t s): nodes_searched(0), TT(s), stopSearch(false), pool(std::max(1u, std::thread::hardware_concurrency())) { }
+SearchStack* Search::thread_stack() {
+    // Each search thread keeps its own stack, so killers survive from one root move to the next.
+    static thread_local SearchStack frames[SEARCH_STACK_SIZE];
+    static thread_local uint32_t generation = UINT32_MAX;
 
-void move_to_front(std::vector<chess::Move>& moves, const chess::Move& move_to_find) {
-    auto it = std::find_if(moves.begin(), moves.end(), [&](const chess::Move& m) { return m.m == move_to_find.m; });
-    if (it != moves.end()) {
-        std::rotate(moves.begin(), it, it + 1);
+    if (generation != stack_generation.load()) {
+        std::fill(std::begin(frames), std::end(frames), SearchStack{});
+        generation = stack_generation.load();
     }
+    return frames + 2;
 }
 
-chess::Move Search::start_search(Board& board, int depth, int movetime, int wtime, int btime, int winc, int binc) {    
+int64_t Search::search_root_move(const Position& root, std::shared_ptr<const GameHistory> history, chess::Move move, int depth, int64_t alpha, int64_t beta) {
+    SearchStack* ss = thread_stack();
+    ss->current_move = move;
+    ss->excluded_move = {};
+
+    Board board(root, history.get());
+
+    // The root frame is what ply 2 compares itself with to decide whether it is improving
+    ss->in_check = board.checks;
+    ss->static_eval = board.checks ? NEG_INFINITY_EVAL : evaluate(board);
+
+    board.make_move(move);
+    return -negamax(board, ss + 1, depth, 1, -beta, -alpha);
+}
+
+// Formats a score for a UCI info line: "cp <x>" or "mate <moves>".
+static std::string score_to_uci(int64_t score) {
+    if (is_mate_score(score)) {
+        const int plies = mate_distance_plies(score);
+        return "mate " + std::to_string(score > 0 ? (plies + 1) / 2 : -(plies / 2));
+    }
+    return "cp " + std::to_string(score);
+}
+
+chess::Move Search::start_search(Board& board, const SearchLimits& limits) {    
     stopSearch.store(false);
     TT.clear();
+    nodes_searched = 0;
+    node_limit = limits.nodes;
+
+    // A node-limited search must give the same result every time, so it never splits the root.
+    const bool split_root = use_thread_pool && limits.nodes == 0;
 
     // for (int i = 0; i < 15; ++i) {
     //     for (int j = 0; j < 64; ++j) {
     //         history_scores[i][j] /= 2; // Halve all scores
     //     }
     // }
-    int time_for_move_ms;
-    auto now = std::chrono::steady_clock::now();
-
-    if (movetime > 0) {
-        // A fixed time search was requested.
-        time_for_move_ms = movetime;
-        searchEndTime = now + std::chrono::milliseconds(time_for_move_ms);
+    time_manager.init(limits, board.white_to_move, board.game_phase, options.move_overhead_ms);
+    // Without a movetime or a clock the other limits or "stop" end the search.
+    searchEndTime = time_manager.hard_deadline();
+
+    // Legal root moves, restricted to "searchmoves" when given.
+    chess::MoveList root_moves;
+    MoveGen::init(board, root_moves, false);
+    if (!limits.searchmoves.empty()) {
+        root_moves.erase(std::remove_if(root_moves.begin(), root_moves.end(), [&](const chess::Move& m) {
+            return std::none_of(limits.searchmoves.begin(), limits.searchmoves.end(), [&](const chess::Move& s) { return s.m == m.m; });
+        }), root_moves.end());
     }
-    else if (wtime > 0 || btime > 0) {
-        int remaining_time = board.white_to_move ? wtime : btime;
-        int increment      = board.white_to_move ? winc  : binc;
-
-        double phase = std::clamp((board.game_phase*1.0) / util::TOTAL_PHASE, 0.0, 1.0);
-
-        double base_time = (remaining_time / 25.0) + increment;
 
-        int time_for_move_ms = static_cast<int>(base_time);
+    // What every root move starts from: a memcpy-able position plus the game so far, shared
+    // read-only. The shared_ptr keeps the history alive for tasks still running after a stop.
+    const Position root = board;
+    const auto history = std::make_shared<const GameHistory>(board.game_history());
 
-        if (phase > 0.15) time_for_move_ms = std::min(time_for_move_ms, 3500); // cap 3.5 sec max
-        if (phase > 0.05) time_for_move_ms = std::min(time_for_move_ms, 8000); // cap 8 sec max
-        else time_for_move_ms = std::min(time_for_move_ms, 15000); // cap 15 sec max
-
-        if (remaining_time < 3 * 60 * 1000) {
-            time_for_move_ms = 3000;
-        }
-        
-        if(remaining_time < 1*60*1000) time_for_move_ms = 1000;
+    // Always have something to play, even if the very first iteration is interrupted.
+    chess::Move best_move_overall = root_moves.empty() ? chess::Move{} : root_moves[0];
+    int64_t last_score = 0;
 
-        time_for_move_ms = std::min(time_for_move_ms, remaining_time - 50);
+    const int max_depth = limits.depth > 0 ? std::min(limits.depth, 60) : 60;
 
-        searchEndTime = now + std::chrono::milliseconds(time_for_move_ms);
-    } else {
-        // If no time is given, we assume 5 seconds
-        searchEndTime = std::chrono::steady_clock::now() + std::chrono::seconds(5); 
-    }
-    
-    chess::Move best_move_overall{};
-    int64_t last_score = 0;
+    // Root moves in the order they are searched, with the score of the last attempt.
+    // Re-sorted after every attempt, failed or not, so a re-search starts with the best moves so far.
+    std::vector<std::pair<chess::Move, int64_t>> root_order;
+    for (const auto& m : root_moves) root_order.push_back({m, NEG_INFINITY_EVAL});
+    aspiration_fail_lows = aspiration_fail_highs = 0;
 
-    for (int i = 1; i <= 60; ++i) {
+    for (int i = 1; i <= max_depth; ++i) {
 
         if (std::chrono::steady_clock::now() >= searchEndTime) {
             break;
         }
 
-        nodes_searched = 0;
-        
-        int64_t alpha, beta;
+        root_depth = i;
+
+        // Full window for the shallow iterations, then a narrow window around the
+        // last score that doubles every time the score falls outside of it.
+        int64_t delta = 50;
+        int64_t alpha = CHECKMATE_EVAL, beta = -CHECKMATE_EVAL;
         if (i > 4) {
-            int64_t delta = 50;
-            alpha = last_score - delta;
-            beta = last_score + delta;
-        } else {
-            alpha = CHECKMATE_EVAL;
-            beta = -CHECKMATE_EVAL;
+            alpha = std::max<int64_t>(last_score - delta, CHECKMATE_EVAL);
+            beta  = std::min<int64_t>(last_score + delta, -CHECKMATE_EVAL);
         }
 
         while(true) {
-            std::vector<chess::Move> moveList;
-            MoveGen::init(board, moveList, false);
-            if (!best_move_overall.is_null()) {
-                move_to_front(moveList, best_move_overall);
-            }
-
             int64_t current_alpha = alpha;
             chess::Move best_move_this_iter{};
+            for (auto& entry : root_order) entry.second = NEG_INFINITY_EVAL;
 
-            if (!moveList.empty()) {
-                chess::Move m = moveList[0];
-                board.make_move(m);
-                if (board.is_position_legal()) {
-                    int64_t s = -negamax(board, i - 1, 1, -beta, -current_alpha);
-                    if (s > current_alpha) {
-                        current_alpha = s;
-                        best_move_this_iter = m;
-                    }
+            if (!root_order.empty()) {
+                chess::Move m = root_order[0].first;
+                int64_t s = search_root_move(root, history, m, i - 1, current_alpha, beta);
+                root_order[0].second = s;
+                if (s > current_alpha) {
+                    current_alpha = s;
+                    best_move_this_iter = m;
                 }
-                board.unmake_move(m);
             }
             if (stopSearch.load()) break;
 
-            std::vector<std::pair<std::future<int64_t>, chess::Move>> futures;
-            for (size_t j = 1; j < moveList.size(); ++j) {
-                Board b_copy = board;
-                b_copy.make_move(moveList[j]);
-                if (!b_copy.is_position_legal()) continue;
-                futures.push_back({pool.enqueue(&Search::negamax, this, b_copy, i - 1, 1, -beta, -current_alpha), moveList[j]});
+            std::vector<std::pair<std::future<int64_t>, size_t>> futures;
+            for (size_t j = 1; j < root_order.size() && current_alpha < beta; ++j) {
+                const chess::Move m = root_order[j].first;
+                if (split_root) {
+                    futures.push_back({pool.enqueue(&Search::search_root_move, this, root, history, m, i - 1, current_alpha, beta), j});
+                    continue;
+                }
+
+                int64_t s = search_root_move(root, history, m, i - 1, current_alpha, beta);
+                if (stopSearch.load()) break;
+
+                root_order[j].second = s;
+                if (s > current_alpha) {
+                    current_alpha = s;
+                    best_move_this_iter = m;
+                }
             }
             
-            for (auto& [future, move] : futures) {
+            for (auto& [future, j] : futures) {
                 if (stopSearch.load()) break;
-                int64_t s = -future.get();
+                int64_t s = future.get();
 
+                root_order[j].second = s;
                 if (s > current_alpha) {
                     current_alpha = s;
-                    best_move_this_iter = move;
+                    best_move_this_iter = root_order[j].first;
                 }
-
-                // std::cout << s << ": " << util::move_to_string(move) << '\n';
             }
             
             if (stopSearch.load()) break;
 
+            std::stable_sort(root_order.begin(), root_order.end(),
+                             [](const auto& a, const auto& b) { return a.second > b.second; });
+
+            // Every fail doubles the window. Past ten pawns a narrow window is pointless: open the bound completely.
+            delta *= 2;
             if (current_alpha <= alpha) { // Fail-low
-                alpha = CHECKMATE_EVAL;
+                aspiration_fail_lows++;
+                beta = (alpha + beta) / 2;
+                alpha = delta > 1000 ? CHECKMATE_EVAL : std::max<int64_t>(alpha - delta, CHECKMATE_EVAL);
                 continue;
             }
             if (current_alpha >= beta) { // Fail-high
-                beta = -CHECKMATE_EVAL;
+                aspiration_fail_highs++;
+                beta = delta > 1000 ? -CHECKMATE_EVAL : std::min<int64_t>(beta + delta, -CHECKMATE_EVAL);
                 continue;
             }
             
@@ -144,12 +195,29 @@ chess::Move Search::start_search(Board& board, int depth, int movetime, int wtim
             break; 
         }
 
-        std::cout << "info depth " << i << " score cp " << last_score
-        << " nodes " << nodes_searched << " pv " << util::move_to_string(best_move_overall) << std::endl;
+        if (stopSearch.load()) break;
 
+        const auto elapsed_ms = time_manager.elapsed_ms();
+        std::cout << "info depth " << i << " score " << score_to_uci(last_score)
+        << " nodes " << nodes_searched << " time " << elapsed_ms
+        << " nps " << (nodes_searched * 1000 / std::max<int64_t>(1, elapsed_ms))
+        << " pv " << util::move_to_string(best_move_overall) << std::endl;
 
-        if (stopSearch.load()) break;
+        // "go mate N": done as soon as we have a forced mate that is short enough.
+        if (limits.mate > 0 && last_score > 0 && is_mate_score(last_score) &&
+            (mate_distance_plies(last_score) + 1) / 2 <= limits.mate) {
+            break;
+        }
+
+        // With only one legal move there is nothing to think about.
+        if (time_manager.is_managed() && root_moves.size() == 1) break;
+
+        if (time_manager.should_stop(i, best_move_overall, last_score)) break;
     }
-    
+
+    std::cout << "info string aspiration re-searches fail-low " << aspiration_fail_lows
+              << " fail-high " << aspiration_fail_highs << std::endl;
+
+    time_manager.finish_move();
     return best_move_overall;
 }
\ No newline at end of file
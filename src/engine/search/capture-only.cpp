@@ -5,14 +5,20 @@
 
 int64_t Search::search_captures_only(Board& board, int ply, int64_t alpha, int64_t beta)
 {   
-    if((ply & 1024) && std::chrono::steady_clock::now() >= searchEndTime) stopSearch.store(true);
+    check_limits();
 
     if(stopSearch.load()) return DRAW_EVAL;
 
+    // Per-ply tables end here, and a mate found past MAX_PLY would not look like one
+    if (ply >= MAX_PLY - 1) return board.checks ? DRAW_EVAL : evaluate(board);
+
     TTEntry entry{};
     int64_t og_alpha = alpha;
+    chess::Move tt_move{};
 
     if(TT.probe(board.zobrist_key, entry)){
+        tt_move = entry.best_move;
+        entry.score = score_from_tt(entry.score, ply);
         if(entry.depth > 0)
         {
             //we only care about exact nodes for Qsearch to avoid bad cutoffs
@@ -23,22 +29,36 @@ int64_t Search::search_captures_only(Board& board, int ply, int64_t alpha, int64
     }
 
     nodes_searched++;
-    int64_t score = evaluate(board);
-    if(score >= beta) return beta;
-    if(score > alpha) alpha = score;
 
-    MoveOrderer orderer(board, ply, *this, true);
+    // In check there is no standing pat: every evasion is searched, and having none is mate.
+    const bool in_check = board.checks;
+    int64_t score = NEG_INFINITY_EVAL;
+    if (!in_check) {
+        score = evaluate(board);
+        if(score >= beta) return beta;
+        if(score > alpha) alpha = score;
+    }
+
+    MoveOrderer orderer(board, nullptr, *this, tt_move, true);
     chess::Move move{};
     chess::Move best_move{};
+    int moves_searched = 0;
+
+    const int64_t stand_pat = score;
 
     while(!(move = orderer.get_next_move()).is_null())
     {
-        board.make_move(move);
-        if(!board.is_position_legal()){
-            board.unmake_move(move);
-            continue;
+        moves_searched++;
+        if (!in_check && !(move.flags() & chess::FLAG_PROMO)) {
+            // Delta pruning: even winning the captured piece for free leaves us below alpha.
+            const chess::PieceType victim = (move.flags() & chess::FLAG_EP) ? chess::PAWN : chess::type_of(board.board_array[move.to()]);
+            if (stand_pat + util::see_values[victim] + QSEARCH_DELTA_MARGIN <= alpha) continue;
+
+            // Captures that lose material in the exchange cannot raise the stand pat.
+            if (!board.see_ge(move, 0)) continue;
         }
-        
+
+        board.make_move(move);
         score = -search_captures_only(board, ply+1, -beta, -alpha);
         board.unmake_move(move);
 
@@ -50,7 +70,9 @@ int64_t Search::search_captures_only(Board& board, int ply, int64_t alpha, int64
         }
     }
 
-    entry = { board.zobrist_key, 0, alpha, TTEntry::EXACT, best_move };
+    if (in_check && moves_searched == 0) return CHECKMATE_EVAL + ply;
+
+    entry = { board.zobrist_key, 0, score_to_tt(alpha, ply), TTEntry::EXACT, best_move };
     TT.store(entry);
 
     return alpha;
@@ -2,41 +2,56 @@
 #include "chess/movegen.h"
 #include "engine/move_orderer.h"
 
+// Null move is off below this ply during a verification search. One per search thread.
+static thread_local int null_move_min_ply = 0;
 
-int64_t Search::negamax(Board& board, int depth, int ply, int64_t alpha, int64_t beta)
+
+int64_t Search::negamax(Board& board, SearchStack* ss, int depth, int ply, int64_t alpha, int64_t beta, bool cut_node)
 {
-    if ((nodes_searched & 1024) == 0 && std::chrono::steady_clock::now() >= searchEndTime) {
-            stopSearch.store(true);
-        }
+    check_limits();
 
-    if ((nodes_searched & 1024) == 0 && stopSearch.load()) {
+    if (stopSearch.load()) {
         return DRAW_EVAL;
     }
 
+    // Per-ply tables end here
+    if (ply >= MAX_PLY - 1) {
+        return evaluate(board);
+    }
+
     if(ply > 0)
     {
         if(board.halfmove_clock >= 100) return DRAW_EVAL;
 
-        // the position can only repeat if there were no pawn pushes or captures
-        // half move clock records that number of moves (so we dont have to search the entire undo stack)
-        int end_index = board.undo_stack.size(); 
-        int rep_count{};
-        int start_index = std::max(0, end_index - (int)(board.halfmove_clock));
-        for(; start_index < end_index; ++start_index)
-        {
-            if(board.zobrist_key == board.undo_stack[start_index].zobrist_before) ++rep_count;
-            if(rep_count >= 2) return DRAW_EVAL; //2 times already and this is the third time
-        }
+        // Searches the game before the root too, through board.history
+        if(board.is_repetition_draw()) return DRAW_EVAL;
+    }
+
+    // Mate distance pruning: even mating right here cannot beat a shorter mate found already,
+    // and being mated here cannot be worse than a faster mate against us.
+    if (ply > 0) {
+        alpha = std::max<int64_t>(alpha, CHECKMATE_EVAL + ply);
+        beta  = std::min<int64_t>(beta, -(CHECKMATE_EVAL + ply + 1));
+        if (alpha >= beta) return alpha;
     }
 
-    if (board.checks) {
+    // Extensions are only granted up to twice the iteration depth, so a line can never run past MAX_PLY.
+    const bool can_extend = ply < 2 * root_depth;
+
+    if (board.checks && can_extend) {
         depth++;
     }
 
+    const bool pv_node = beta - alpha > 1;
+    const bool excluding = !ss->excluded_move.is_null();
+
     TTEntry entry{};
     int64_t og_alpha = alpha;
+    const bool tt_hit = TT.probe(board.zobrist_key, entry);
+    if (tt_hit) entry.score = score_from_tt(entry.score, ply);
 
-    if(TT.probe(board.zobrist_key, entry)){
+    // The entry belongs to the full position, not to the one without the excluded move.
+    if(tt_hit && !excluding){
         if(entry.depth >= depth)
         {
             if(entry.bound == TTEntry::EXACT) return entry.score;
@@ -47,77 +62,215 @@ int64_t Search::negamax(Board& board, int depth, int ply, int64_t alpha, int64_t
         if(alpha >= beta) return entry.score;
     }
 
-    // Conditions to apply Null move pruning:
-    // 1. Not in check.
-    // 2. Not in the first few plies of the game.
-    // 3. The current search depth is deep enough (e.g., > 2).
-    // 4. The side to move has enough non-pawn material (to avoid zugzwang issues).
-    if (!board.checks && ply > 0 && depth > 2 && (board.white_to_move ? board.material_white > 3000 : board.material_black > 3000)) {
-        // The reduction factor 'R' is typically 2 or 3.
-        int R = 3;
+    const chess::Move tt_move = tt_hit ? entry.best_move : chess::Move{};
+    const TTEntry tt_entry = entry;
+
+    // Internal iterative reduction: a PV or expected cut node without a hash move is most likely
+    // poorly ordered; search it shallower and let the next iteration come back with a move.
+    if (tt_move.is_null() && depth >= 4 && (pv_node || cut_node) && !excluding) {
+        depth--;
+    }
+
+    const bool board_in_check = board.checks;
+    const bool prunable = ply > 0 && !pv_node && !board_in_check && !excluding;
+
+    // The exclusion search shares the frame with its parent and keeps its eval.
+    ss->in_check = board_in_check;
+    if (!excluding) {
+        ss->static_eval = board_in_check ? NEG_INFINITY_EVAL : evaluate(board);
+    }
+    const int64_t static_eval = ss->static_eval;
 
-        board.make_move({});
-        int64_t null_score = -negamax(board, depth - 1 - R, ply + 1, -beta, -beta + 1);
-        board.unmake_move({}); 
+    // Is our position getting better than two plies ago? If not, prune and reduce more.
+    ss->improving = !board_in_check && ((ss - 2)->static_eval == NEG_INFINITY_EVAL || static_eval > (ss - 2)->static_eval);
+    const bool improving = ss->improving;
+
+    // Reverse futility pruning: so far above beta that a quiet move will not bring the opponent back.
+    if (options.reverse_futility_pruning && prunable && depth <= 6 && !is_mate_score(beta) &&
+        static_eval - 80 * (depth - improving) >= beta) {
+        return beta;
+    }
+
+    // Razoring: hopelessly below alpha near the horizon, only a tactic can help, so ask qsearch.
+    if (options.razoring && prunable && depth <= 2 && static_eval + 250 * depth < alpha) {
+        int64_t razor_score = search_captures_only(board, ply, alpha, alpha + 1);
+        if (razor_score <= alpha) return alpha;
+    }
+
+    // Futility pruning: quiet moves at frontier nodes cannot lift a hopeless eval above alpha.
+    const bool futile = options.futility_pruning && prunable && depth <= 3 && !is_mate_score(alpha) &&
+                        static_eval + 100 + 120 * depth <= alpha;
+
+    // Null move pruning: if passing the turn still beats beta, a real move will too.
+    // Skipped without pieces (zugzwang), right after the opponent passed and inside a verification search for the same side.
+    if (ply > 0 && !board_in_check && !excluding && !(ss - 1)->current_move.is_null() && depth >= 3 && ply >= null_move_min_ply && static_eval >= beta && !is_mate_score(beta) &&
+        board.has_non_pawn_material(board.white_to_move)) {
+        // Reduce more at high depth and when the eval is far above beta
+        const int R = 3 + depth / 4 + (int)std::min<int64_t>((static_eval - beta) / 200, 3);
+
+        ss->current_move = {};
+        board.make_null_move();
+        int64_t null_score = -negamax(board, ss + 1, depth - 1 - R, ply + 1, -beta, -beta + 1, !cut_node);
+        board.unmake_null_move();
+
+        if (stopSearch.load()) return DRAW_EVAL;
 
-        //even after making a null move the opp couldnt make our score < Beta so its too good lets prune
         if (null_score >= beta) {
-            return beta;
+            if (null_move_min_ply || depth < 10) return beta;
+
+            // At high depth zugzwang could cost real points: verify with a reduced search
+            // in which this side may not pass again for a while.
+            null_move_min_ply = ply + 3 * (depth - R) / 4;
+            int64_t verify_score = negamax(board, ss, depth - R, ply, beta - 1, beta, false);
+            null_move_min_ply = 0;
+
+            if (verify_score >= beta) return beta;
+        }
+    }
+
+    // ProbCut: a capture that beats beta by a clear margin in a shallow search will almost
+    // certainly beat beta in the full one too.
+    const int64_t probcut_beta = beta + PROBCUT_MARGIN;
+    if (options.probcut && prunable && depth >= 5 && !is_mate_score(beta) &&
+        !(tt_hit && tt_entry.depth >= depth - 3 && tt_entry.score < probcut_beta)) {
+        MoveOrderer captures(board, nullptr, *this, tt_move, true);
+        chess::Move capture;
+
+        while(!(capture = captures.get_next_move()).is_null()) {
+            if (!board.see_ge(capture, (int)(probcut_beta - static_eval))) continue;
+
+            board.make_move(capture);
+            ss->current_move = capture;
+
+            // Verify with qsearch first, it is much cheaper
+            int64_t score = -search_captures_only(board, ply + 1, -probcut_beta, -probcut_beta + 1);
+            if (score >= probcut_beta) {
+                score = -negamax(board, ss + 1, depth - 4, ply + 1, -probcut_beta, -probcut_beta + 1, !cut_node);
+            }
+            board.unmake_move(capture);
+
+            if (stopSearch.load()) return DRAW_EVAL;
+
+            if (score >= probcut_beta) {
+                entry = { board.zobrist_key, (uint8_t)(depth - 3), score_to_tt(score, ply), TTEntry::LOWER_BOUND, capture };
+                TT.store(entry);
+                return score;
+            }
         }
     }
 
     nodes_searched++;    
-    if (depth == 0) {
+    if (depth <= 0) {
         return search_captures_only(board, ply, alpha, beta);
     }
     
-    MoveOrderer orderer(board, ply, *this, false);
+    MoveOrderer orderer(board, ss, *this, tt_move, false);
     chess::Move move;
     chess::Move best_move;
 
     int legal_moves_found = 0;
+
+    // Quiet moves searched so far; they get a history malus when a later move cuts off.
+    chess::Move quiets_tried[64];
+    int quiet_count = 0;
     
     while(!(move = orderer.get_next_move()).is_null()){
         if(stopSearch.load()) return DRAW_EVAL;
+        if(move.m == ss->excluded_move.m) continue;
 
-        board.make_move(move);
-        if(!board.is_position_legal()){
-            board.unmake_move(move);
-            continue;
+        // Singular extension: if every other move fails well below the hash move's score,
+        // the hash move is the only good one and deserves an extra ply.
+        int extension = 0;
+        if (move.m == tt_move.m && !excluding && ply > 0 && depth >= 6 && can_extend &&
+            tt_entry.depth >= depth - 3 && tt_entry.bound != TTEntry::UPPER_BOUND && !is_mate_score(tt_entry.score)) {
+            const int64_t singular_beta = tt_entry.score - 2 * depth;
+            ss->excluded_move = move;
+            const int64_t singular_score = negamax(board, ss, (depth - 1) / 2, ply, singular_beta - 1, singular_beta, cut_node);
+            ss->excluded_move = {};
+
+            if (singular_score < singular_beta) {
+                extension = 1;
+            }
+            // Multi-cut: even without the hash move we beat beta
+            else if (singular_beta >= beta) {
+                return beta;
+            }
         }
-        
+
+        const bool is_quiet = !(move.flags() & (chess::FLAG_CAPTURE | chess::FLAG_PROMO | chess::FLAG_EP));
+        const int history = history_scores[board.board_array[move.from()]][move.to()];
+
+        // Classified before making the move, so pruned quiets never touch the board
+        const bool gives_check = board.gives_check(move);
+
+        if (is_quiet && !gives_check && legal_moves_found > 0) {
+            // Late move pruning: at shallow depth, quiets this far down the list practically never cut off.
+            const bool late = options.late_move_pruning && prunable && depth <= 4 &&
+                              legal_moves_found >= (3 + depth * depth) / (improving ? 1 : 2);
+            if (futile || late) continue;
+        }
+
+        board.make_move(move);
+
         legal_moves_found++;
+        ss->current_move = move;
+        if (is_quiet && quiet_count < 64) quiets_tried[quiet_count++] = move;
 
-        // int64_t score = -negamax(board, depth - 1, ply+1, -beta, -alpha);
         int64_t score;
 
-        if (legal_moves_found > 5 && depth > 4 && move.flags() == chess::FLAG_QUIET) {
-            // After the first few moves, if the move is quiet and depth is sufficient...
-            int reduction = std::min(4, 1 + depth / 5);
-            // More complex reductions can depend on depth and move number
-            // Search with a reduced depth
-            score = -negamax(board, depth - 1 - reduction, ply + 1, -alpha - 1, -alpha);
-        } 
-        else {
-            // Ensure the full search is done for the first few moves or if a re-search is needed
-            score = -negamax(board, depth - 1, ply + 1, -beta, -alpha);
+        // Principal variation search: the first move gets the full window, every later one
+        // only has to prove it is no better than alpha, with a zero window.
+        if (legal_moves_found == 1) {
+            score = -negamax(board, ss + 1, depth - 1 + extension, ply + 1, -beta, -alpha, !pv_node && !cut_node);
         }
-        // If the reduced search was better than expected, it might be a good move. Re-search at full depth.
-        if (score > alpha) {
-            score = -negamax(board, depth - 1, ply + 1, -beta, -alpha);
+        else {
+            bool reduced = false;
+
+            // Late move reductions: the deeper and the later the move, the less we expect from it.
+            // Less for PV nodes and for moves with a good history, more for a bad one.
+            if (depth >= 3 && is_quiet && !gives_check && !board_in_check && legal_moves_found > (pv_node ? 3 : 1)) {
+                int reduction = lmr_reductions[std::min(depth, 63)][std::min(legal_moves_found, 63)];
+                if (pv_node) reduction--;
+                if (!improving) reduction++;
+                reduction -= history / 8192;
+                reduction = std::clamp(reduction, 0, depth - 2);
+
+                if (reduction > 0) {
+                    reduced = true;
+                    score = -negamax(board, ss + 1, depth - 1 - reduction, ply + 1, -alpha - 1, -alpha, true);
+                }
+            }
+
+            // Not reduced, or the reduced search was better than expected: zero window at full depth
+            if (!reduced || score > alpha) {
+                score = -negamax(board, ss + 1, depth - 1 + extension, ply + 1, -alpha - 1, -alpha, !cut_node);
+            }
+
+            // Inside the window it may be a new best move: get its exact score
+            if (score > alpha && score < beta) {
+                score = -negamax(board, ss + 1, depth - 1 + extension, ply + 1, -beta, -alpha, false);
+            }
         }
 
         board.unmake_move(move);
 
         if (score >= beta) {
-            if(move.flags() != chess::FLAG_CAPTURE && move.flags() != chess::FLAG_CAPTURE_PROMO && move.flags() != chess::FLAG_EP && move.flags() != chess::FLAG_PROMO) 
-            {
-                update_killers(ply, move);
-                // update_history(board, move, depth);
+            if (is_quiet) {
+                update_killers(ss, move);
+
+                // Deeper cutoffs say more about a move
+                const int bonus = std::min(16 * depth * depth, 1200);
+                // The cutoff move is not in the list once it is full, so skip it by value
+                for (int i = 0; i < quiet_count; ++i) {
+                    if (quiets_tried[i].m != move.m) update_history(board, quiets_tried[i], -bonus);
+                }
+                update_history(board, move, bonus);
             }
 
-            entry = { board.zobrist_key, (uint8_t)depth, score, TTEntry::LOWER_BOUND, move };
-            TT.store(entry);
+            if (!excluding) {
+                entry = { board.zobrist_key, (uint8_t)depth, score_to_tt(score, ply), TTEntry::LOWER_BOUND, move };
+                TT.store(entry);
+            }
 
             return beta; 
         }
@@ -127,16 +280,21 @@ int64_t Search::negamax(Board& board, int depth, int ply, int64_t alpha, int64_t
         }
     }
     
+    // Never a mate since the excluded move is legal, and the result must stay out of the TT
+    if (excluding) {
+        return alpha;
+    }
+
     if (legal_moves_found == 0) {
         // checkmate + ply to favor checkmates found with least amount of moves
-        entry = { board.zobrist_key, (int8_t)MAX_PLY, board.checks ? CHECKMATE_EVAL + ply : DRAW_EVAL, TTEntry::EXACT, {} };
+        entry = { board.zobrist_key, (uint8_t)MAX_PLY, score_to_tt(board.checks ? CHECKMATE_EVAL + ply : DRAW_EVAL, ply), TTEntry::EXACT, {} };
         TT.store(entry);
         return board.checks ? CHECKMATE_EVAL + ply : DRAW_EVAL;
     }
     
     TTEntry::Bound bound = (alpha <= og_alpha) ? TTEntry::UPPER_BOUND : TTEntry::EXACT;
 
-    entry = { board.zobrist_key, (uint8_t)depth, alpha, bound, best_move };
+    entry = { board.zobrist_key, (uint8_t)depth, score_to_tt(alpha, ply), bound, best_move };
     TT.store(entry);
 
     return alpha;
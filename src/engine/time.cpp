@@ -1,3 +1,112 @@
-// #include "time.h"
+#include "engine/time.h"
+#include "engine/search.h"
+#include "chess/util.h"
+#include <algorithm>
 
-// // Implementation goes here
+void TimeManager::init(const SearchLimits& limits, bool white_to_move, int game_phase, int move_overhead_ms)
+{
+    start_time = Clock::now();
+    overhead_ms = move_overhead_ms;
+    managed = false;
+    clock_ms = 0;
+    soft_ms = hard_ms = 0;
+
+    last_best_move = {};
+    best_move_stable_iterations = 0;
+    last_score = 0;
+
+    if (limits.movetime > 0) {
+        // A fixed time search: use all of it, minus the overhead.
+        soft_ms = hard_ms = std::max<int64_t>(1, limits.movetime - overhead_ms);
+        return;
+    }
+
+    if (limits.wtime <= 0 && limits.btime <= 0) {
+        return; // no clock: the search is ended by its other limits or "stop"
+    }
+
+    managed = true;
+    const int64_t remaining = white_to_move ? limits.wtime : limits.btime;
+    const int64_t increment = white_to_move ? limits.winc  : limits.binc;
+    clock_ms = remaining;
+
+    // Moves still to be played on this clock. Without movestogo we expect more
+    // moves to come while there is still material on the board.
+    const double phase = std::clamp(game_phase / (double)util::TOTAL_PHASE, 0.0, 1.0);
+    const int moves_to_go = limits.movestogo > 0 ? std::min(limits.movestogo, 50) : 20 + (int)(20 * phase);
+
+    // Time for the next moves_to_go moves, with the overhead reserved for each of them.
+    const int64_t available = std::max<int64_t>(1, remaining + increment * (moves_to_go - 1) - overhead_ms * moves_to_go);
+
+    // The last move before the time control may use most of the clock; otherwise never bet more than half of it.
+    const int64_t safe_remaining = std::max<int64_t>(1, remaining - overhead_ms);
+    const double max_fraction = (moves_to_go == 1) ? 0.9 : 0.5;
+
+    hard_ms = std::max<int64_t>(1, std::min<int64_t>(available / moves_to_go * 4, (int64_t)(safe_remaining * max_fraction)));
+    soft_ms = std::clamp<int64_t>(available / moves_to_go, 1, hard_ms);
+}
+
+TimeManager::Clock::time_point TimeManager::hard_deadline() const
+{
+    if (hard_ms == 0) return Clock::time_point::max();
+    return start_time + std::chrono::milliseconds(hard_ms);
+}
+
+int64_t TimeManager::elapsed_ms() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_time).count();
+}
+
+bool TimeManager::should_stop(int depth, const chess::Move& best_move, int64_t score)
+{
+    best_move_stable_iterations = (best_move.m == last_best_move.m) ? best_move_stable_iterations + 1 : 0;
+    const int64_t score_drop = (depth > 1) ? last_score - score : 0;
+    last_best_move = best_move;
+    last_score = score;
+
+    if (!managed) return false;
+
+    // A best move that survived several iterations is unlikely to change: save time.
+    // One that just changed deserves a closer look.
+    double scale = 1.0;
+    if (best_move_stable_iterations >= 4) scale = 0.5;
+    else if (best_move_stable_iterations >= 2) scale = 0.8;
+    else if (best_move_stable_iterations == 0 && depth > 1) scale = 1.4;
+
+    // A falling score means trouble, so look for a way out.
+    if (score_drop > 80) scale *= 1.6;
+    else if (score_drop > 30) scale *= 1.25;
+
+    const int64_t limit = std::min<int64_t>(hard_ms, (int64_t)(soft_ms * scale));
+    return elapsed_ms() >= limit;
+}
+
+void TimeManager::finish_move()
+{
+    if (!managed) return;
+
+    const int64_t used = elapsed_ms();
+    moves_timed++;
+    total_time_ms += used;
+
+    // The GUI sees our thinking time plus the overhead. More than the clock means we lost on time.
+    if (used + overhead_ms > clock_ms && !flagged_this_game) {
+        flagged_this_game = true;
+        games_lost_on_time++;
+    }
+}
+
+void TimeManager::new_game()
+{
+    games++;
+    flagged_this_game = false;
+}
+
+void TimeManager::report(std::ostream& out) const
+{
+    out << "info string time stats games " << games
+        << " lost on time " << games_lost_on_time
+        << " moves " << moves_timed
+        << " avg ms/move " << (moves_timed ? total_time_ms / (int64_t)moves_timed : 0)
+        << std::endl;
+}
@@ -1,11 +1,13 @@
 #include "engine/uci.h"
 #include "engine/opening_book.h"
-#include "chess/zobrist.h"
+#include <algorithm>
+
+EngineOptions options;
 
 // Helper function to find a move in the legal move list that matches a UCI move string
 // This version correctly handles promotion moves.
 chess::Move parse_move(Board& board, const std::string& move_string) {
-    std::vector<chess::Move> legal_moves;
+    chess::MoveList legal_moves;
     MoveGen::init(board, legal_moves, false);
 
     for (const auto& move : legal_moves) {
@@ -30,10 +32,29 @@ chess::Move parse_move(Board& board, const std::string& move_string) {
     return {}; // Return a null move if not found
 }
 
+// The undo stack only has room for MAX_GAME_MOVES game moves. Past that, continue from the current
+// position with an empty stack and keep the hashes a repetition can still reach: those since the
+// last capture or pawn move.
+static void trim_game_history(Board& board) {
+    static GameHistory kept;
+    const GameHistory keys = board.game_history();
+    const size_t keep = std::min<size_t>(keys.size(), board.halfmove_clock);
+    kept.assign(keys.end() - keep, keys.end());
+    board.undo_stack.clear();
+    board.history = &kept;
+}
+
 // Function to run the search in a separate thread
 // This version correctly formats the output string for promotion moves.
-void start_search_thread(Board board, Search* search_agent, int depth, int movetime, int wtime, int btime, int winc, int binc) {
-    chess::Move best_move = search_agent->start_search(board, depth, movetime, wtime, btime, winc, binc);
+// The thread owns a copy of the position and the game so far, so "position" may change the GUI's board meanwhile.
+void start_search_thread(Position position, std::shared_ptr<const GameHistory> history, Search* search_agent, SearchLimits limits) {
+    Board board(position, history.get());
+    chess::Move best_move = search_agent->start_search(board, limits);
+
+    // "go infinite" may only answer once the GUI has sent "stop", even if we ran out of depth.
+    while (limits.infinite && !search_agent->stopSearch.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
 
     std::string move_str = util::move_to_string(best_move);
 
@@ -51,6 +72,52 @@ void start_search_thread(Board board, Search* search_agent, int depth, int movet
     std::cout << "bestmove " << move_str << std::endl;
 }
 
+// Fixed-depth search over a fixed set of positions, run on a single thread.
+// The total node count is reproducible and serves as a regression signature for search changes.
+void bench(Search& search_agent, int depth) {
+    static const char* bench_fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14",
+        "4rrk1/2p1b1p1/p1p3q1/4p3/2P2n1p/1P1NR2P/PB3PP1/3R1QK1 b - - 2 24",
+        "r3qbrk/6p1/2b2pPp/p3pP1Q/PpPpP2P/3P1B2/2PB3K/R5R1 w - - 16 42",
+        "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 0 1",
+        "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+    };
+
+    const bool pool_setting = search_agent.use_thread_pool;
+    search_agent.use_thread_pool = false;
+
+    uint64_t total_nodes = 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const char* fen : bench_fens) {
+        std::string fen_str = fen;
+        Board board;
+        board.set_fen(fen_str);
+        std::cout << "\nPosition: " << fen_str << std::endl;
+
+        search_agent.clear();
+        SearchLimits limits;
+        limits.depth = depth;
+        chess::Move best = search_agent.start_search(board, limits);
+        std::cout << "bestmove " << util::move_to_string(best) << std::endl;
+        total_nodes += search_agent.nodes_searched;
+    }
+
+    const auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    search_agent.use_thread_pool = pool_setting;
+
+    std::cout << "\n===========================" << std::endl;
+    std::cout << "Total time (ms) : " << elapsed_ms << std::endl;
+    std::cout << "Nodes searched  : " << total_nodes << std::endl;
+    std::cout << "Nodes/second    : " << total_nodes * 1000 / std::max<int64_t>(1, elapsed_ms) << std::endl;
+}
+
 void uci(Board &board, Search& search_agent, std::thread& search_thread, OpeningBook& white_book, OpeningBook& black_book){
     std::string line;
     while (std::getline(std::cin, line)) {
@@ -61,13 +128,40 @@ void uci(Board &board, Search& search_agent, std::thread& search_thread, Opening
         if (token == "uci") {
             std::cout << "id name Hagnus-Carlsen" << std::endl;
             std::cout << "id author Vardaan-Harshit" << std::endl;
+            std::cout << "option name Move Overhead type spin default 30 min 0 max 5000" << std::endl;
+            std::cout << "option name Reverse Futility Pruning type check default true" << std::endl;
+            std::cout << "option name Futility Pruning type check default true" << std::endl;
+            std::cout << "option name Razoring type check default true" << std::endl;
+            std::cout << "option name Late Move Pruning type check default true" << std::endl;
+            std::cout << "option name ProbCut type check default true" << std::endl;
             std::cout << "uciok" << std::endl;
         } else if (token == "isready") {
-            Zobrist::init_zobrist_keys(); 
-            chess::init(); // Initialize bitboards and other pre-computed data
+            // All tables are ready before main(), so there is nothing to do here
             std::cout << "readyok" << std::endl;
+        } else if (token == "setoption") {
+            // setoption name <id> [value <x>], where <id> may contain spaces
+            std::string word, name, value;
+            iss >> word; // "name"
+            while (iss >> word && word != "value") name += (name.empty() ? "" : " ") + word;
+            std::getline(iss >> std::ws, value);
+
+            if (name == "Move Overhead") {
+                options.move_overhead_ms = std::clamp(std::atoi(value.c_str()), 0, 5000);
+            } else if (name == "Reverse Futility Pruning") {
+                options.reverse_futility_pruning = (value == "true");
+            } else if (name == "Futility Pruning") {
+                options.futility_pruning = (value == "true");
+            } else if (name == "Razoring") {
+                options.razoring = (value == "true");
+            } else if (name == "Late Move Pruning") {
+                options.late_move_pruning = (value == "true");
+            } else if (name == "ProbCut") {
+                options.probcut = (value == "true");
+            }
         } else if (token == "ucinewgame") {
-            search_agent.TT.clear(); // Clear the transposition table for a new game
+            search_agent.clear(); // Clear the transposition table and move ordering tables for a new game
+            if (search_agent.time_manager.games_played() > 0) search_agent.time_manager.report(std::cout);
+            search_agent.time_manager.new_game();
         } else if (token == "position") {
             std::string pos_type;
             iss >> pos_type;
@@ -98,16 +192,42 @@ void uci(Board &board, Search& search_agent, std::thread& search_thread, Opening
                 while (iss >> move_str) {
                     chess::Move m = parse_move(board, move_str);
                     if (!m.is_null()) {
+                        if (board.undo_stack.size() >= (size_t)chess::MAX_GAME_MOVES) trim_game_history(board);
                         board.make_move(m);
                     }
                 }
             }
         } else if (token == "go") {
+            SearchLimits limits;
+            std::string go_param;
+            bool reading_searchmoves = false;
+
+            while(iss >> go_param) {
+                if (go_param == "depth") iss >> limits.depth;
+                else if (go_param == "nodes") iss >> limits.nodes;
+                else if (go_param == "mate") iss >> limits.mate;
+                else if (go_param == "movetime") iss >> limits.movetime;
+                else if (go_param == "wtime") iss >> limits.wtime;
+                else if (go_param == "btime") iss >> limits.btime;
+                else if (go_param == "winc") iss >> limits.winc;
+                else if (go_param == "binc") iss >> limits.binc;
+                else if (go_param == "movestogo") iss >> limits.movestogo;
+                else if (go_param == "infinite") limits.infinite = true;
+                else if (go_param == "searchmoves") reading_searchmoves = true;
+                else if (reading_searchmoves) {
+                    chess::Move m = parse_move(board, go_param);
+                    if (!m.is_null()) limits.searchmoves.push_back(m);
+                }
+            }
+
+            // Analysis and fixed-cost searches always search; only game play takes book moves.
+            const bool analysis = limits.depth || limits.nodes || limits.mate || limits.infinite || !limits.searchmoves.empty();
+
             uint64_t current_hash = board.zobrist_key; 
             
             // Choose the correct book based on whose turn it is
             OpeningBook& active_book = (board.white_to_move) ? white_book : black_book;
-            std::optional<std::string> book_move = active_book.getRandomMove(current_hash);
+            std::optional<std::string> book_move = analysis ? std::nullopt : active_book.getRandomMove(current_hash);
             
             std::cout << "Hash : " << current_hash << std::endl;
 
@@ -120,23 +240,18 @@ void uci(Board &board, Search& search_agent, std::thread& search_thread, Opening
                     search_thread.join();
                 }
                 
-                int wtime = 0, btime = 0, winc = 0, binc = 0;
-                int movetime = 0;
-                int depth = 64;
-                std::string go_param;
-                
-                while(iss >> go_param) {
-                    if (go_param == "depth") ; /* iss >> depth; */ //Ignore depth command only work on time;
-                    else if(go_param == "movetime") iss >> movetime;
-                    else if (go_param == "wtime") iss >> wtime;
-                    else if (go_param == "btime") iss >> btime;
-                    else if (go_param == "winc") iss >> winc;
-                    else if (go_param == "binc") iss >> binc;
-                }
-                
                 search_agent.stopSearch.store(false);
-                search_thread = std::thread(start_search_thread, board, &search_agent, depth, movetime, wtime, btime, winc, binc);
+                search_thread = std::thread(start_search_thread, static_cast<const Position&>(board),
+                                            std::make_shared<const GameHistory>(board.game_history()), &search_agent, limits);
+            }
+        } else if (token == "bench") {
+            int depth = 7;
+            iss >> depth;
+            if (search_thread.joinable()) {
+                search_agent.stopSearch.store(true);
+                search_thread.join();
             }
+            bench(search_agent, depth);
         } else if (token == "stop") {
             search_agent.stopSearch.store(true);
             if (search_thread.joinable()) {
@@ -147,6 +262,7 @@ void uci(Board &board, Search& search_agent, std::thread& search_thread, Opening
             if (search_thread.joinable()) {
                 search_thread.join();
             }
+            search_agent.time_manager.report(std::cout);
             break; // Exit the loop and terminate the program
         }
     }
@@ -5,9 +5,65 @@
 
 using namespace std;
 
+// Slow reference: walk each ray until the edge or the first blocker
+uint64_t slider_attacks_reference(int sq, uint64_t occupancy, const int (&dirs)[4][2]){
+    uint64_t attacks = 0;
+    for (const auto& d : dirs){
+        int r = sq / 8 + d[0], f = sq % 8 + d[1];
+        while (r >= 0 && r < 8 && f >= 0 && f < 8){
+            attacks |= 1ULL << (r * 8 + f);
+            if (occupancy & (1ULL << (r * 8 + f))) break;
+            r += d[0]; f += d[1];
+        }
+    }
+    return attacks;
+}
+
+// Checks the packed slider tables (magic or PEXT indexed) against the reference on every
+// blocker subset of each square's mask, plus random full-board occupancies.
+int check_slider_attacks(){
+    static const int rook_dirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    static const int bishop_dirs[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    mt19937_64 rng(2024);
+    int failures = 0;
+
+    for (int sq = chess::A1; sq <= chess::H8; sq++){
+        const chess::Square s = chess::Square(sq);
+        for (int piece = 0; piece < 2; piece++){
+            const uint64_t mask = piece ? chess::BishopMagics[sq].mask : chess::RookMagics[sq].mask;
+            const auto& dirs = piece ? bishop_dirs : rook_dirs;
+
+            vector<uint64_t> occupancies;
+            uint64_t b = 0;
+            do {
+                occupancies.push_back(b);
+                b = (b - mask) & mask;
+            } while (b);
+            for (int i = 0; i < 256; i++) occupancies.push_back(rng() & rng());
+
+            for (uint64_t occ : occupancies){
+                const uint64_t got = piece ? chess::get_diagonal_slider_attacks(s, occ) : chess::get_orthogonal_slider_attacks(s, occ);
+                if (got != slider_attacks_reference(sq, occ, dirs)){
+                    if (failures++ < 5) cout << (piece ? "Bishop" : "Rook") << " attacks wrong on square " << sq << " occupancy " << occ << "\n";
+                }
+            }
+        }
+    }
+    return failures;
+}
+
 int main(){
     chess::init();
 
+#if defined(USE_PEXT)
+    cout << "Slider attacks (PEXT): ";
+#else
+    cout << "Slider attacks (magic): ";
+#endif
+    const int failures = check_slider_attacks();
+    cout << (failures ? "FAILED" : "passed") << endl;
+    if (failures) return 1;
+
     // White Pawns
     // for (int i = chess::A1 ; i <= chess::H8 ; i++){
     //     chess::print_bitboard(chess::PawnAttacks[0][i]);
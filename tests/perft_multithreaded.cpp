@@ -55,25 +55,15 @@ uint64_t perft(Board& board, int depth) {
         return 1ULL;
     }
 
-    std::vector<chess::Move> moveList;
-    // Generate all pseudo-legal moves for the current position.
+    chess::MoveList moveList;
+    // Generate all legal moves for the current position.
     MoveGen::init(board, moveList, false);
     uint64_t nodes = 0;
     // Iterate through all generated moves
     for (const auto& move : moveList) {
         // Make the move on the board
         board.make_move(move);
-
-        // After making a move, the king of the side that just moved should
-        // not be in check by the opponent. If it is, the move was illegal.
-        chess::Square king_sq = board.white_to_move
-            ? board.black_king_sq // Black just moved, check their king
-            : board.white_king_sq; // White just moved, check their king
-
-        // square_attacked checks if the opponent is attacking the king's square.
-        if (!board.square_attacked(king_sq, board.white_to_move)) {
-            nodes += perft(board, depth - 1);
-        }
+        nodes += perft(board, depth - 1);
 
         // Unmake the move to restore the board to its original state for the next iteration.
         board.unmake_move(move);
@@ -85,7 +75,7 @@ uint64_t perft(Board& board, int depth) {
 uint64_t perft_threaded(Board& root_board, int depth, ThreadPool& pool) {
     if (depth == 0) return 1ULL;
 
-    std::vector<chess::Move> moveList;
+    chess::MoveList moveList;
     MoveGen::init(root_board, moveList, false);
     std::vector<std::future<uint64_t>> futures;
     uint64_t total_nodes = 0;
@@ -95,16 +85,12 @@ uint64_t perft_threaded(Board& root_board, int depth, ThreadPool& pool) {
         Board board_copy = root_board;
         board_copy.make_move(move);
 
-        chess::Square king_sq = board_copy.white_to_move ? board_copy.black_king_sq : board_copy.white_king_sq;
-        if (!board_copy.square_attacked(king_sq, board_copy.white_to_move)) {
-             // If the move is legal, enqueue the rest of the search.
-             // We pass board_copy by value to ensure each thread has its own instance.
-            futures.emplace_back(
-                pool.enqueue([board_copy, depth]() mutable {
-                    return perft(board_copy, depth - 1);
-                })
-            );
-        }
+        // We pass board_copy by value to ensure each thread has its own instance.
+        futures.emplace_back(
+            pool.enqueue([board_copy, depth]() mutable {
+                return perft(board_copy, depth - 1);
+            })
+        );
     }
 
     // Collect results from all futures
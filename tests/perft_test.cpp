@@ -1,9 +1,10 @@
-// compile using : g++ -I../include/chess -o perft_test.out perft_test.cpp ../src/chess/*.cpp ../src/chess/movegen/*.cpp
+// compile using : g++ -I../include -I../include/chess -o perft_test.out perft_test.cpp ../src/chess/*.cpp ../src/chess/movegen/*.cpp
 
 #include <iostream>
 #include <vector>
 #include <chrono>
 #include <iomanip> // For std::fixed and std::setprecision
+#include <algorithm>
 #include "board.h"
 #include "movegen.h"
 #include "types.h"
@@ -12,6 +13,64 @@
 // Forward declaration of the main perft function
 uint64_t perft(Board& board, int depth);
 
+static bool same_moves(chess::MoveList a, chess::MoveList b) {
+    auto by_value = [](const chess::Move& x, const chess::Move& y) { return x.m < y.m; };
+    std::sort(a.begin(), a.end(), by_value);
+    std::sort(b.begin(), b.end(), by_value);
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const chess::Move& x, const chess::Move& y) { return x.m == y.m; });
+}
+
+// Walks the tree and checks every GenType against the full move list. Returns the number of bad nodes.
+uint64_t check_gen_types(Board& board, int depth) {
+    chess::MoveList all, captures, quiets, evasions, quiet_checks;
+    MoveGen::generate<MoveGen::ALL>(board, all);
+    MoveGen::generate<MoveGen::CAPTURES>(board, captures);
+    MoveGen::generate<MoveGen::QUIETS>(board, quiets);
+    MoveGen::generate<MoveGen::QUIET_CHECKS>(board, quiet_checks);
+
+    // CAPTURES and QUIETS split ALL
+    chess::MoveList both = captures;
+    for (const auto& m : quiets) both.push_back(m);
+    bool ok = same_moves(both, all);
+
+    if (board.checks) {
+        MoveGen::generate<MoveGen::EVASIONS>(board, evasions);
+        ok = ok && same_moves(evasions, all);
+    }
+
+    // QUIET_CHECKS are exactly the quiet non-promotions that leave the opponent in check
+    chess::MoveList expected_checks;
+    for (const auto& m : quiets) {
+        if (m.flags() & chess::FLAG_PROMO) continue;
+        board.make_move(m);
+        if (board.checks) expected_checks.push_back(m);
+        board.unmake_move(m);
+    }
+    ok = ok && same_moves(quiet_checks, expected_checks);
+
+    // gives_check agrees with making the move, for every kind of move
+    for (const auto& m : all) {
+        const bool predicted = board.gives_check(m);
+        board.make_move(m);
+        ok = ok && predicted == (board.checks != 0);
+        board.unmake_move(m);
+    }
+
+    if (!ok) {
+        std::cout << "  GenType mismatch in " << board.to_fen() << "\n";
+    }
+
+    uint64_t bad = ok ? 0 : 1;
+    if (depth > 1) {
+        for (const auto& m : all) {
+            board.make_move(m);
+            bad += check_gen_types(board, depth - 1);
+            board.unmake_move(m);
+        }
+    }
+    return bad;
+}
+
 // The perft function remains unchanged
 uint64_t perft(Board& board, int depth) {
     // Base case: If we've reached the desired depth, we've found one leaf node.
@@ -19,33 +78,17 @@ uint64_t perft(Board& board, int depth) {
         return 1ULL;
     }
 
-    std::vector<chess::Move> moveList;
-    // Generate all pseudo-legal moves for the current position.
+    chess::MoveList moveList;
+    // Generate all legal moves for the current position.
     MoveGen::init(board, moveList, false);
 
     uint64_t nodes = 0;
 
     // Iterate through all generated moves
     for (const auto& move : moveList) {
-        // Make the move on the board
-        uint64_t curPin = board.pinned;
-        uint64_t check = board.checks;
-        chess::Square currKingSq = (board.white_to_move) ? board.white_king_sq : board.black_king_sq;
+        // Every generated move is legal, so no check after making it
         board.make_move(move);
-
-        // After making a move, the king of the side that just moved should
-        // not be in check by the opponent. If it is, the move was illegal.
-        chess::Square king_sq = board.white_to_move 
-            ? board.black_king_sq // Black just moved, check their king
-            : board.white_king_sq; // White just moved, check their king
-        
-        if(curPin || check || move.from() == (int)(currKingSq) || move.flags() == chess::FLAG_EP)
-        {
-            if(!board.square_attacked(king_sq,board.white_to_move))
-            nodes += perft(board, depth - 1);
-        }
-        else nodes += perft(board, depth - 1);
-
+        nodes += perft(board, depth - 1);
 
         // Unmake the move to restore the board to its original state
         board.unmake_move(move);
@@ -129,6 +172,13 @@ int main() {
             }
         }
         
+        const uint64_t bad_nodes = check_gen_types(board, 3);
+        std::cout << "  generation modes (depth 3): " << (bad_nodes == 0 ? "✅ Passed" : "❌ FAIL") << "\n";
+        if (bad_nodes) {
+            all_tests_passed = false;
+            current_test_passed = false;
+        }
+
         if (!current_test_passed) {
             std::cout << "\n🔴 Test case FAILED.\n";
         }
@@ -12,7 +12,7 @@
 
 // Helper function to parse a UCI move string and find the corresponding move
 chess::Move parse_move(Board& b, const std::string& move_str) {
-    std::vector<chess::Move> moveList;
+    chess::MoveList moveList;
     MoveGen::init(b, moveList, false);
     for (const auto& move : moveList) {
         if (util::move_to_string(move) == move_str) {
@@ -150,6 +150,7 @@ int main() {
     // --- THIS IS THE MOST IMPORTANT FIX ---
     // Initialize the Zobrist keys *before* doing anything else.
     Zobrist::init_zobrist_keys(); 
+    chess::init(); // attack tables, needed by make_move's pin/check detection
     // ------------------------------------
 
     std::cout << "==========================================\n";